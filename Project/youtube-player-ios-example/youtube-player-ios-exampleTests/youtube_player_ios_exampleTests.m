@@ -12,19 +12,191 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#import <JavaScriptCore/JavaScriptCore.h>
 #import <OCMock/OCMock.h>
 #import <XCTest/XCTest.h>
 #import <WebKit/WebKit.h>
 
+#import "YTAutoplaySelector.h"
+#import "YTBridgeEventScheduler.h"
+#import "YTCommandEffectTracker.h"
+#import "YTPlayerBudgetManager.h"
+#import "YTPlayerHostView.h"
+#import "YTPlayerMetricsHUDView.h"
 #import "YTPlayerView.h"
+#import "YTVideoId.h"
 
 @interface youtube_player_ios_exampleTests : XCTestCase
 
 @end
 
+@interface YTPlayerHostView (ExposedForTesting) <WKScriptMessageHandler, WKNavigationDelegate>
+- (void)setWebView:(WKWebView *)webView;
+- (WKWebView *)createNewWebViewWithConfiguration:(WKWebViewConfiguration *)configuration;
+@end
+
 @interface YTPlayerView (ExposedForTesting)
 - (void)setWebView:(WKWebView *)webView;
 - (WKWebView *) createNewWebView;
+- (void)flushSphericalProperties:(CADisplayLink *)displayLink;
+- (void)stopSphericalDisplayLink;
++ (NSString *)bridgeScript;
++ (NSDictionary *)playerCallbacks;
++ (NSString *)contentsOfResource:(NSString *)name ofType:(NSString *)type;
+@end
+
+/**
+ * A player view that never creates a real WKWebView, so that the portable parts of the player
+ * lifecycle (load request, HTML render, command encoding, event decoding, teardown) can be
+ * measured without WebKit process overhead.
+ */
+@interface YTFeedCellPlayerView : YTPlayerView
+@end
+
+@implementation YTFeedCellPlayerView
+
+- (WKWebView *)createNewWebView {
+  return OCMClassMock([WKWebView class]);
+}
+
+@end
+
+// The scheme of the local stand-in for the YouTube endpoints used by the time-to-ready test.
+NSString static *const kYTStandInScheme = @"ytstandin";
+
+// A stand-in for the iframe API whose players become ready on the next microtask, so that
+// time-to-ready measures the page and the bridge rather than the network.
+NSString static *const kYTStandInIframeAPI =
+    @"var YT = {"
+     "  PlayerState: { UNSTARTED: -1, ENDED: 0, PLAYING: 1, PAUSED: 2, BUFFERING: 3, CUED: 5 },"
+     "  Player: function(element, params) {"
+     "    var player = this;"
+     "    player.getPlayerState = function() { return YT.PlayerState.UNSTARTED; };"
+     "    player.getOptions = function() { return []; };"
+     "    Promise.resolve().then(function() {"
+     "      params.events.onReady({ target: player, data: null });"
+     "    });"
+     "  }"
+     "};"
+     "onYouTubeIframeAPIReady();";
+
+/** Serves kYTStandInIframeAPI for every request of its scheme. */
+@interface YTStandInSchemeHandler : NSObject <WKURLSchemeHandler>
+@end
+
+@implementation YTStandInSchemeHandler
+
+- (void)webView:(WKWebView *)webView startURLSchemeTask:(id<WKURLSchemeTask>)urlSchemeTask {
+  NSData *data = [kYTStandInIframeAPI dataUsingEncoding:NSUTF8StringEncoding];
+  NSURLResponse *response = [[NSURLResponse alloc] initWithURL:urlSchemeTask.request.URL
+                                                      MIMEType:@"text/javascript"
+                                         expectedContentLength:data.length
+                                              textEncodingName:@"utf-8"];
+  [urlSchemeTask didReceiveResponse:response];
+  [urlSchemeTask didReceiveData:data];
+  [urlSchemeTask didFinish];
+}
+
+- (void)webView:(WKWebView *)webView stopURLSchemeTask:(id<WKURLSchemeTask>)urlSchemeTask {
+}
+
+@end
+
+/** A player view whose web view serves the stand-in iframe API for kYTStandInScheme. */
+@interface YTStandInPlayerView : YTPlayerView
+@end
+
+@implementation YTStandInPlayerView
+
+- (WKWebView *)createNewWebView {
+  WKWebViewConfiguration *configuration = [[WKWebViewConfiguration alloc] init];
+  [configuration setURLSchemeHandler:[[YTStandInSchemeHandler alloc] init]
+                        forURLScheme:kYTStandInScheme];
+  return [[WKWebView alloc] initWithFrame:self.bounds configuration:configuration];
+}
+
+@end
+
+/** A host view whose shared web view is a mock, so that the page it loads can be inspected. */
+@interface YTMockWebViewHostView : YTPlayerHostView
+
+@property(nonatomic, readonly) id mockWebView;
+
+@end
+
+@implementation YTMockWebViewHostView
+
+- (WKWebView *)createNewWebViewWithConfiguration:(WKWebViewConfiguration *)configuration {
+  if (!_mockWebView) {
+    _mockWebView = OCMClassMock([WKWebView class]);
+  }
+  return _mockWebView;
+}
+
+@end
+
+/**
+ * A stand-in for the IFrame API player that feeds scripted state changes and play time reports
+ * to a YTCommandEffectTracker on a virtual clock, so that command matching can be tested without
+ * a page.
+ */
+@interface YTScriptedPlayer : NSObject
+
+@property(nonatomic, readonly) YTCommandEffectTracker *tracker;
+@property(nonatomic, readonly) NSTimeInterval now;
+
+/** Reports |state| |delay| seconds from now. */
+- (void)reportState:(YTPlayerState)state after:(NSTimeInterval)delay;
+
+/** Reports a play time of |seconds| |delay| seconds from now. */
+- (void)reportPlayTime:(double)seconds after:(NSTimeInterval)delay;
+
+/** Moves the clock forward, delivering due reports in order and expiring late commands. */
+- (void)advanceBy:(NSTimeInterval)interval;
+
+@end
+
+@implementation YTScriptedPlayer {
+  NSMutableArray<NSArray *> *_reports;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _tracker = [[YTCommandEffectTracker alloc] init];
+    _reports = [NSMutableArray array];
+    _now = 100;
+  }
+  return self;
+}
+
+- (void)reportState:(YTPlayerState)state after:(NSTimeInterval)delay {
+  [_reports addObject:@[ @(_now + delay), @"state", @(state) ]];
+}
+
+- (void)reportPlayTime:(double)seconds after:(NSTimeInterval)delay {
+  [_reports addObject:@[ @(_now + delay), @"time", @(seconds) ]];
+}
+
+- (void)advanceBy:(NSTimeInterval)interval {
+  NSTimeInterval end = _now + interval;
+  [_reports sortWithOptions:NSSortStable usingComparator:^(NSArray *a, NSArray *b) {
+    return [a[0] compare:b[0]];
+  }];
+  while (_reports.count > 0 && [_reports[0][0] doubleValue] <= end) {
+    NSArray *report = _reports[0];
+    [_reports removeObjectAtIndex:0];
+    _now = [report[0] doubleValue];
+    if ([report[1] isEqualToString:@"state"]) {
+      [_tracker observeState:[report[2] integerValue] atTime:_now];
+    } else {
+      [_tracker observePlayTime:[report[2] doubleValue] atTime:_now];
+    }
+  }
+  _now = end;
+  [_tracker expireCommandsAtTime:_now];
+}
+
 @end
 
 @implementation youtube_player_ios_exampleTests {
@@ -107,6 +279,167 @@
   [partialWebViewMock verify];
 }
 
+- (void)testLoadPlayerInitialState {
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      return [html rangeOfString:@"var initialState = {\"playbackRate\":1.5};"].location != NSNotFound;
+  }]
+                                      baseURL:[OCMArg any]];
+  YTPlayerInitialState *initialState = [[YTPlayerInitialState alloc] init];
+  initialState.playbackRate = @1.5;
+  [partialPlayer loadWithVideoId:@"VIDEO_ID_HERE" playerVars:nil initialState:initialState];
+  [partialWebViewMock verify];
+}
+
+- (void)testLoadPlayerWithoutInitialState {
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      return [html rangeOfString:@"var initialState = null;"].location != NSNotFound;
+  }]
+                                      baseURL:[OCMArg any]];
+  [partialPlayer loadWithVideoId:@"VIDEO_ID_HERE"];
+  [partialWebViewMock verify];
+}
+
+- (void)testLoadPlayerWithConfiguration {
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      return [html rangeOfString:@"\"videoId\":\"VIDEO_ID_HERE\""].location != NSNotFound &&
+             [html rangeOfString:@"\"playerVars\":{\"playsinline\":1,\"origin\":"].location != NSNotFound;
+  }]
+                                      baseURL:[OCMArg any]];
+  YTPlayerConfigurationBuilder *builder = [[YTPlayerConfigurationBuilder alloc] init];
+  builder.playsInline = YES;
+  YTPlayerConfiguration *configuration = [builder buildWithError:nil];
+  XCTAssertNotNil(configuration);
+  [partialPlayer loadWithVideoId:@"VIDEO_ID_HERE" configuration:configuration];
+  [partialWebViewMock verify];
+}
+
+- (void)testLoadPlayerInlinesBridgeScript {
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      return [html rangeOfString:@"function sendEvent(action, query)"].location != NSNotFound;
+  }]
+                                      baseURL:[OCMArg any]];
+  [partialPlayer loadWithVideoId:@"VIDEO_ID_HERE"];
+  [partialWebViewMock verify];
+}
+
+- (void)testPageServerRouting {
+  YTPlayerPageServer *server = [[YTPlayerPageServer alloc] initWithBridgeScript:@"var a = 1;"];
+  NSURL *origin = [NSURL URLWithString:@"ytplayer-page://com.example.app"];
+  NSURL *pageURL = [NSURL URLWithString:server.pagePath relativeToURL:origin];
+  XCTAssertEqual([server responseForRequest:[NSURLRequest requestWithURL:pageURL]].statusCode,
+                 404);
+
+  server.pageHTML = @"<html></html>";
+  YTPlayerPageResponse *response =
+      [server responseForRequest:[NSURLRequest requestWithURL:pageURL]];
+  XCTAssertEqual(response.statusCode, 200);
+  XCTAssertEqualObjects(response.headerFields[@"Content-Type"], @"text/html; charset=utf-8");
+  XCTAssertEqualObjects(response.body, [@"<html></html>" dataUsingEncoding:NSUTF8StringEncoding]);
+
+  // Every request is answered in full, from the script encoded when the server was created.
+  NSURL *bridgeURL = [NSURL URLWithString:server.bridgeScriptPath relativeToURL:origin];
+  NSURLRequest *bridgeRequest = [NSURLRequest requestWithURL:bridgeURL];
+  YTPlayerPageResponse *first = [server responseForRequest:bridgeRequest];
+  YTPlayerPageResponse *second = [server responseForRequest:bridgeRequest];
+  XCTAssertEqual(first.statusCode, 200);
+  XCTAssertEqualObjects(first.headerFields[@"Content-Length"], @"10");
+  XCTAssertEqualObjects(first.body, [@"var a = 1;" dataUsingEncoding:NSUTF8StringEncoding]);
+  XCTAssertEqual(second.body, first.body);
+
+  NSMutableURLRequest *post = [NSMutableURLRequest requestWithURL:bridgeURL];
+  post.HTTPMethod = @"POST";
+  XCTAssertEqual([server responseForRequest:post].statusCode, 405);
+  NSURL *unknownURL = [NSURL URLWithString:@"/unknown.js" relativeToURL:origin];
+  XCTAssertEqual([server responseForRequest:[NSURLRequest requestWithURL:unknownURL]].statusCode,
+                 404);
+}
+
+- (void)testPlayersServedFromMemoryReuseTheirServerAndProcess {
+  if (@available(iOS 11.0, *)) {
+    YTPlayerView *first = [[YTPlayerView alloc] init];
+    YTPlayerView *second = [[YTPlayerView alloc] init];
+    first.servesPageFromMemory = YES;
+    second.servesPageFromMemory = YES;
+    WKWebViewConfiguration *firstLoad = [first createNewWebView].configuration;
+    WKWebViewConfiguration *secondLoad = [first createNewWebView].configuration;
+    WKWebViewConfiguration *otherPlayer = [second createNewWebView].configuration;
+
+    // A second load of the player is served by the same handler and server.
+    id<WKURLSchemeHandler> handler =
+        [firstLoad urlSchemeHandlerForURLScheme:kYTPlayerPageURLScheme];
+    XCTAssertNotNil(handler);
+    XCTAssertEqual([secondLoad urlSchemeHandlerForURLScheme:kYTPlayerPageURLScheme], handler);
+    XCTAssertEqual(secondLoad.processPool, firstLoad.processPool);
+    XCTAssertEqual(otherPlayer.processPool, firstLoad.processPool);
+  }
+}
+
+- (void)testConfigurationValidation {
+  YTPlayerConfigurationBuilder *builder = [[YTPlayerConfigurationBuilder alloc] init];
+  builder.startSeconds = 30;
+  builder.endSeconds = 10;
+  NSError *error = nil;
+  XCTAssertNil([builder buildWithError:&error]);
+  XCTAssertEqualObjects(error.domain, YTPlayerConfigurationErrorDomain);
+  XCTAssertEqual(error.code, kYTPlayerConfigurationErrorInvalidEndSeconds);
+
+  builder.endSeconds = 0;
+  builder.playlist = @[ @"abc", @"d'ef" ];
+  XCTAssertNil([builder buildWithError:&error]);
+  XCTAssertEqual(error.code, kYTPlayerConfigurationErrorInvalidPlaylist);
+
+  builder.playlist = nil;
+  YTPlayerInitialState *initialState = [[YTPlayerInitialState alloc] init];
+  initialState.seekToSeconds = @(NAN);
+  builder.initialState = initialState;
+  XCTAssertNil([builder buildWithError:&error]);
+  XCTAssertEqual(error.code, kYTPlayerConfigurationErrorInvalidInitialState);
+}
+
+- (void)testConfigurationLoopsSingleVideo {
+  YTPlayerConfigurationBuilder *builder = [[YTPlayerConfigurationBuilder alloc] init];
+  builder.loop = YES;
+  YTPlayerConfiguration *configuration = [builder buildWithError:nil];
+  XCTAssertEqualObjects([configuration playerVarsJSONWithOrigin:@"http://origin"
+                                                playlistVideoId:@"abc"],
+                        @"{\"loop\":1,\"playlist\":\"abc\",\"origin\":\"http:\\/\\/origin\"}");
+}
+
+- (void)testConfigurationLoopsPlaylistFromAdditionalPlayerVars {
+  YTPlayerConfigurationBuilder *builder = [[YTPlayerConfigurationBuilder alloc] init];
+  builder.loop = YES;
+  builder.additionalPlayerVars = @{@"playlist" : @"abc,def"};
+  YTPlayerConfiguration *configuration = [builder buildWithError:nil];
+  XCTAssertTrue(configuration.hasPlaylist);
+
+  // The loaded video is not appended as a second "playlist" key.
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      NSArray *parts = [html componentsSeparatedByString:@"\"playlist\":"];
+      return parts.count == 2 && [parts[1] hasPrefix:@"\"abc,def\""];
+  }] baseURL:[OCMArg any]];
+  [partialPlayer loadWithVideoId:@"M7lc1UVf-VE" configuration:configuration];
+  [partialWebViewMock verify];
+}
+
 - (id)makePartialPlayerMockWithWebView:(WKWebView *)webView {
   id partialPlayer = [OCMockObject partialMockForObject:playerView];
   OCMStub([partialPlayer webView]).andReturn(webView);
@@ -144,6 +477,1040 @@
   [mockWebView verify];
 }
 
+#pragma mark - Layout
+
+- (void)testResizesDeferred {
+  [[mockWebView expect] evaluateJavaScript:@"setResizesDeferred(true);" completionHandler:[OCMArg any]];
+  playerView.resizesDeferred = YES;
+  // Setting the same value again must not evaluate anything.
+  playerView.resizesDeferred = YES;
+  [mockWebView verify];
+
+  [[mockWebView expect] evaluateJavaScript:@"setResizesDeferred(false);" completionHandler:[OCMArg any]];
+  playerView.resizesDeferred = NO;
+  [mockWebView verify];
+}
+
+#pragma mark - Command protocol
+
+- (void)testCommandEncoderBatch {
+  YTPlayerCommandEncoder *encoder = [[YTPlayerCommandEncoder alloc] init];
+  [encoder appendCommand:kYTPlayerOpcodeSeekTo arguments:@[ @12.5, @YES ]];
+  [encoder appendCommand:kYTPlayerOpcodePlayVideo arguments:nil];
+  NSArray *expectedCommands = @[ @[ @(kYTPlayerOpcodeSeekTo), @12.5, @YES ],
+                                 @[ @(kYTPlayerOpcodePlayVideo) ] ];
+  XCTAssertEqualObjects(encoder.commands, expectedCommands);
+  XCTAssertEqualObjects([encoder javaScriptSource], @"dispatchCommands([[4,12.5,true],[1]]);");
+
+  [encoder removeAllCommands];
+  XCTAssertEqual(encoder.commands.count, 0);
+}
+
+- (void)testBridgeCommandTableMatchesOpcodes {
+  NSMutableArray *methodNames = [NSMutableArray arrayWithObject:@"null"];
+  for (YTPlayerOpcode opcode = kYTPlayerOpcodePlayVideo; opcode <= kYTPlayerOpcodeMax; opcode++) {
+    [methodNames addObject:[NSString stringWithFormat:@"'%@'",
+                                     [YTPlayerCommandEncoder methodNameForOpcode:opcode]]];
+  }
+  NSString *bridgeScript = [YTPlayerView bridgeScript];
+  NSRange start = [bridgeScript rangeOfString:@"var commandMethods = ["];
+  XCTAssertNotEqual(start.location, NSNotFound);
+  NSUInteger tableStart = NSMaxRange(start);
+  NSRange end = [bridgeScript rangeOfString:@"];"
+                                    options:0
+                                      range:NSMakeRange(tableStart, bridgeScript.length - tableStart)];
+  NSString *table = [bridgeScript substringWithRange:NSMakeRange(tableStart, end.location - tableStart)];
+  NSArray *pageMethodNames = [[table componentsSeparatedByCharactersInSet:
+      [NSCharacterSet characterSetWithCharactersInString:@", \n"]]
+      filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+  XCTAssertEqualObjects(pageMethodNames, methodNames);
+}
+
+- (void)testCommandProtocolSendsOneBatch {
+  playerView.usesCommandProtocol = YES;
+  NSArray *expectedCommands = @[ @[ @(kYTPlayerOpcodeSeekTo), @30, @YES ],
+                                 @[ @(kYTPlayerOpcodeSetPlaybackRate), @1.5 ],
+                                 @[ @(kYTPlayerOpcodePlayVideo) ] ];
+  if (@available(iOS 14.0, *)) {
+    [[mockWebView expect] callAsyncJavaScript:@"dispatchCommands(commands);"
+                                    arguments:@{@"commands" : expectedCommands}
+                                      inFrame:nil
+                               inContentWorld:[OCMArg any]
+                            completionHandler:[OCMArg any]];
+  } else {
+    [[mockWebView expect] evaluateJavaScript:@"dispatchCommands([[4,30,true],[14,1.5],[1]]);"
+                           completionHandler:[OCMArg any]];
+  }
+  [playerView performCommandBatch:^{
+    [playerView seekToSeconds:30 allowSeekAhead:YES];
+    [playerView setPlaybackRate:1.5];
+    [playerView playVideo];
+  }];
+  [mockWebView verify];
+}
+
+- (void)testCommandEncoderRejectsNonJSONArguments {
+  YTPlayerCommandEncoder *encoder = [[YTPlayerCommandEncoder alloc] init];
+  XCTAssertTrue([encoder appendCommand:kYTPlayerOpcodePlayVideo arguments:nil]);
+  XCTAssertFalse([encoder appendCommand:kYTPlayerOpcodeSeekTo arguments:@[ @(NAN), @YES ]]);
+  XCTAssertEqual(encoder.commands.count, 1);
+  XCTAssertEqualObjects([encoder javaScriptSource], @"dispatchCommands([[1]]);");
+}
+
+- (void)testCommandProtocolFallsBackToSourceForNonJSONArguments {
+  playerView.usesCommandProtocol = YES;
+  [[mockWebView expect] evaluateJavaScript:[OCMArg checkWithBlock:^BOOL(NSString *js) {
+    return [js hasPrefix:@"player.seekTo("];
+  }] completionHandler:[OCMArg any]];
+  [playerView seekToSeconds:NAN allowSeekAhead:NO];
+  [mockWebView verify];
+}
+
+/**
+ * Returns a JavaScript context running the bridge script with stand-ins for the browser objects
+ * it uses. Events the script sends are collected in its sentEvents array, and animation frame
+ * callbacks are held until its runFrames() function is called.
+ */
+- (JSContext *)bridgeContext {
+  JSContext *context = [[JSContext alloc] init];
+  context.exceptionHandler = ^(JSContext *context, JSValue *exception) {
+    XCTFail(@"%@", exception);
+  };
+  [context evaluateScript:
+      @"var sentEvents = [];"
+       "var pendingFrames = [];"
+       "var window = {"
+       "  innerWidth: 320,"
+       "  innerHeight: 180,"
+       "  location: {},"
+       "  addEventListener: function(type, listener) { window['on' + type] = listener; },"
+       "  setInterval: function() {},"
+       "  setTimeout: function() {},"
+       "  requestAnimationFrame: function(callback) { pendingFrames.push(callback); }"
+       "};"
+       "Object.defineProperty(window.location, 'href', {"
+       "  set: function(url) { sentEvents.push(url.split('&seq=')[0]); }"
+       "});"
+       "var performance = { now: function() { return 0; } };"
+       "function runFrames() {"
+       "  var frames = pendingFrames;"
+       "  pendingFrames = [];"
+       "  frames.forEach(function(callback) { callback(); });"
+       "}"
+       "var playerParams = { events: {} };"
+       "var initialState = null;"];
+  [context evaluateScript:[YTPlayerView bridgeScript]];
+  return context;
+}
+
+- (void)testPageDispatchesCommands {
+  JSContext *context = [self bridgeContext];
+  [context evaluateScript:
+      @"var calls = [];"
+       "player = {"
+       "  playVideo: function() { calls.push(['playVideo']); return player; },"
+       "  seekTo: function(seconds, allowSeekAhead) {"
+       "    calls.push(['seekTo', seconds, allowSeekAhead]);"
+       "    return player;"
+       "  },"
+       "  setPlaybackRate: function(rate) { calls.push(['setPlaybackRate', rate]); return player; }"
+       "};"];
+  YTPlayerCommandEncoder *encoder = [[YTPlayerCommandEncoder alloc] init];
+  [encoder appendCommand:kYTPlayerOpcodeSeekTo arguments:@[ @30, @YES ]];
+  [encoder appendCommand:kYTPlayerOpcodeSetPlaybackRate arguments:@[ @1.5 ]];
+  // Methods the player does not have are skipped.
+  [encoder appendCommand:kYTPlayerOpcodeStopVideo arguments:nil];
+  [encoder appendCommand:kYTPlayerOpcodePlayVideo arguments:nil];
+  NSArray *expectedCalls = @[ @[ @"seekTo", @30, @YES ], @[ @"setPlaybackRate", @1.5 ],
+                              @[ @"playVideo" ] ];
+
+  // As passed by callAsyncJavaScript, which needs a result it can serialize.
+  JSValue *result = [context[@"dispatchCommands"] callWithArguments:@[ encoder.commands ]];
+  XCTAssertTrue(result.isUndefined);
+  XCTAssertEqualObjects([context[@"calls"] toArray], expectedCalls);
+
+  // As evaluated from source on older systems.
+  [context evaluateScript:@"calls = [];"];
+  [context evaluateScript:[encoder javaScriptSource]];
+  XCTAssertEqualObjects([context[@"calls"] toArray], expectedCalls);
+}
+
+- (void)testPageCoalescesResizesIntoOneSetSizePerFrame {
+  JSContext *context = [self bridgeContext];
+  [context evaluateScript:
+      @"var sizes = [];"
+       "player = { setSize: function(width, height) { sizes.push([width, height]); } };"
+       "for (var i = 0; i < 5; i++) { window.onresize(); }"];
+  XCTAssertEqual([[context evaluateScript:@"pendingFrames.length"] toInt32], 1);
+  [context evaluateScript:@"runFrames();"];
+  XCTAssertEqualObjects([context[@"sizes"] toArray], (@[ @[ @320, @180 ] ]));
+
+  // A resize to the same size is skipped.
+  [context evaluateScript:@"window.onresize(); runFrames();"];
+  XCTAssertEqual([[context evaluateScript:@"sizes.length"] toInt32], 1);
+
+  // Deferred resizes are held until native resumes them, then applied once.
+  [context evaluateScript:
+      @"setResizesDeferred(true);"
+       "window.innerWidth = 640;"
+       "window.onresize();"
+       "window.onresize();"];
+  XCTAssertEqual([[context evaluateScript:@"pendingFrames.length"] toInt32], 0);
+  [context evaluateScript:@"setResizesDeferred(false); runFrames();"];
+  XCTAssertEqualObjects([context[@"sizes"] toArray], (@[ @[ @320, @180 ], @[ @640, @180 ] ]));
+}
+
+// Stubs the player of |context| with methods that do nothing, for the dispatch benchmarks.
+- (void)stubPlayerInBridgeContext:(JSContext *)context {
+  [context evaluateScript:
+      @"player = {"
+       "  seekTo: function() { return player; },"
+       "  cueVideoById: function() { return player; }"
+       "};"];
+}
+
+// Dispatches 10000 commands to the page in batches of 32, passed as arguments as on iOS 14 and
+// later, encoding included. Compare with testCommandSourceEvaluationPerformance.
+- (void)testCommandDispatchPerformance {
+  JSContext *context = [self bridgeContext];
+  [self stubPlayerInBridgeContext:context];
+  JSValue *dispatchCommands = context[@"dispatchCommands"];
+  [self measureBlock:^{
+    YTPlayerCommandEncoder *encoder = [[YTPlayerCommandEncoder alloc] init];
+    for (int i = 0; i < 5000; i++) {
+      [encoder appendCommand:kYTPlayerOpcodeSeekTo arguments:@[ @(i / 4.0f), @YES ]];
+      [encoder appendCommand:kYTPlayerOpcodeCueVideoById
+                   arguments:@[ @{@"videoId" : @"M7lc1UVf-VE", @"startSeconds" : @(i)} ]];
+      if (i % 16 == 15) {
+        [dispatchCommands callWithArguments:@[ encoder.commands ]];
+        [encoder removeAllCommands];
+      }
+    }
+  }];
+}
+
+// Sends the same 10000 commands as testCommandDispatchPerformance as one script each, the way
+// they are sent without the command protocol, formatting and parsing included.
+- (void)testCommandSourceEvaluationPerformance {
+  JSContext *context = [self bridgeContext];
+  [self stubPlayerInBridgeContext:context];
+  [self measureBlock:^{
+    for (int i = 0; i < 5000; i++) {
+      [context evaluateScript:[NSString stringWithFormat:@"player.seekTo(%@, %@);",
+                                                         @(i / 4.0f), @"true"]];
+      [context evaluateScript:[NSString stringWithFormat:@"player.cueVideoById({'videoId': '%@',"
+                                                         "'startSeconds': %@});",
+                                                         @"M7lc1UVf-VE", @(i)]];
+    }
+  }];
+}
+
+#pragma mark - Metrics
+
+- (void)testMetricsAggregation {
+  YTPlayerMetrics *metrics = [[YTPlayerMetrics alloc] init];
+  YTPlayerMetricsSnapshot snapshot = [metrics snapshotAtTime:100];
+  XCTAssertEqual(snapshot.eventsPerSecond, 0);
+  XCTAssertTrue(isnan(snapshot.lastGetterRoundTrip));
+  XCTAssertTrue(isnan(snapshot.timeSinceLastPlayTime));
+  XCTAssertEqual(snapshot.playerState, kYTPlayerStateUnknown);
+
+  for (int i = 0; i < 8; i++) {
+    [metrics recordEventAtTime:100.1 + i * 0.1];
+  }
+  [metrics recordPlayTimeAtTime:100.5];
+  [metrics recordCommandSent];
+  [metrics recordCommandSent];
+  [metrics recordCommandCompleted];
+  [metrics recordGetterRoundTrip:0.012];
+  metrics.playerState = kYTPlayerStatePlaying;
+  metrics.bufferedAheadSeconds = 8;
+
+  snapshot = [metrics snapshotAtTime:101.2];
+  XCTAssertEqual(snapshot.eventsPerSecond, 8);
+  XCTAssertEqual(snapshot.pendingCommandCount, 1);
+  XCTAssertEqualWithAccuracy(snapshot.lastGetterRoundTrip, 0.012, 1e-9);
+  XCTAssertEqualWithAccuracy(snapshot.timeSinceLastPlayTime, 0.7, 1e-9);
+  XCTAssertEqual(snapshot.playerState, kYTPlayerStatePlaying);
+  XCTAssertEqual(snapshot.bufferedAheadSeconds, 8);
+
+  // A second without events brings the rate back to zero.
+  XCTAssertEqual([metrics snapshotAtTime:102.5].eventsPerSecond, 0);
+
+  [metrics reset];
+  snapshot = [metrics snapshotAtTime:103];
+  XCTAssertEqual(snapshot.pendingCommandCount, 0);
+  XCTAssertTrue(isnan(snapshot.timeSinceLastPlayTime));
+}
+
+- (void)testMetricsFollowBridge {
+  [[mockWebView stub] evaluateJavaScript:[OCMArg any] completionHandler:[OCMArg any]];
+  playerView.delegate = nil;
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  [self sendCallbackURL:@"ytplayer://onPlayTime?data=10&loaded=0.5&duration=100&rate=1"
+           toPlayerView:playerView];
+  [playerView playVideo];
+
+  YTPlayerMetricsSnapshot snapshot = [playerView.metrics snapshotAtTime:CACurrentMediaTime()];
+  XCTAssertEqual(snapshot.playerState, kYTPlayerStatePlaying);
+  XCTAssertEqualWithAccuracy(snapshot.bufferedAheadSeconds, 40, 1e-6);
+  XCTAssertFalse(isnan(snapshot.timeSinceLastPlayTime));
+  XCTAssertEqual(snapshot.pendingCommandCount, 1);
+}
+
+- (void)testMetricsHUD {
+  YTPlayerMetricsSnapshot snapshot = {
+    .eventsPerSecond = 3,
+    .pendingCommandCount = 2,
+    .lastGetterRoundTrip = 0.004,
+    .timeSinceLastPlayTime = NAN,
+    .playerState = kYTPlayerStateBuffering,
+    .bufferedAheadSeconds = 1.25
+  };
+  NSString *text = [YTPlayerMetricsHUDView textForSnapshot:snapshot];
+  XCTAssertTrue([text containsString:@"events/s  3\n"]);
+  XCTAssertTrue([text containsString:@"getter    4 ms\n"]);
+  XCTAssertTrue([text containsString:@"playTime  -\n"]);
+  XCTAssertTrue([text containsString:@"state     buffering\n"]);
+
+  playerView.showsMetricsHUD = YES;
+  XCTAssertEqual([[playerView.subviews filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:
+      @"self isKindOfClass: %@", [YTPlayerMetricsHUDView class]]] count], 1);
+  playerView.showsMetricsHUD = NO;
+  XCTAssertEqual([[playerView.subviews filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:
+      @"self isKindOfClass: %@", [YTPlayerMetricsHUDView class]]] count], 0);
+}
+
+- (void)testMetricsRecordingPerformance {
+  YTPlayerMetrics *metrics = [[YTPlayerMetrics alloc] init];
+  [self measureBlock:^{
+    for (int i = 0; i < 100000; i++) {
+      NSTimeInterval time = i * 0.001;
+      [metrics recordEventAtTime:time];
+      [metrics recordCommandSent];
+      [metrics recordCommandCompleted];
+      if (i % 250 == 0) {
+        [metrics snapshotAtTime:time];
+      }
+    }
+  }];
+}
+
+#pragma mark - Watched ranges
+
+- (void)testWatchedRangesMatchBruteForce {
+  // Random ranges on a grid of tenths of a second, checked against a per-tenth bitmap.
+  srand48(42);
+  for (int round = 0; round < 20; round++) {
+    YTWatchedRanges *ranges = [[YTWatchedRanges alloc] init];
+    ranges.duration = 100;
+    BOOL watched[1000] = { NO };
+    for (int i = 0; i < 200; i++) {
+      int start = (int)(drand48() * 1000);
+      int end = MIN(start + (int)(drand48() * 40), 1000);
+      [ranges addRangeFromTime:start / 10.0 toTime:end / 10.0];
+      for (int tenth = start; tenth < end; tenth++) {
+        watched[tenth] = YES;
+      }
+    }
+    int watchedTenths = 0;
+    for (int tenth = 0; tenth < 1000; tenth++) {
+      watchedTenths += watched[tenth] ? 1 : 0;
+      XCTAssertEqual([ranges containsTime:tenth / 10.0 + 0.05], watched[tenth]);
+    }
+    XCTAssertEqualWithAccuracy(ranges.watchedDuration, watchedTenths / 10.0, 1e-6);
+    XCTAssertEqualWithAccuracy(ranges.watchedFraction, watchedTenths / 1000.0, 1e-6);
+    for (NSUInteger i = 1; i < ranges.rangeCount; i++) {
+      XCTAssertLessThan([ranges rangeAtIndex:i - 1].end, [ranges rangeAtIndex:i].start);
+    }
+  }
+}
+
+- (void)testWatchedRangesFromSamples {
+  YTWatchedRanges *ranges = [[YTWatchedRanges alloc] init];
+  ranges.duration = 100;
+  for (int i = 0; i <= 10; i++) {
+    [ranges addSampleWithCurrentTime:i * 0.5 playbackRate:1 timestamp:i * 0.5];
+  }
+  // Seeking ahead leaves the skipped part out.
+  [ranges addSampleWithCurrentTime:30 playbackRate:1 timestamp:5.5];
+  [ranges addSampleWithCurrentTime:30.5 playbackRate:1 timestamp:6];
+  // Paused for a while, then played at double speed.
+  [ranges interruptSampling];
+  [ranges addSampleWithCurrentTime:30.5 playbackRate:2 timestamp:20];
+  [ranges addSampleWithCurrentTime:31.5 playbackRate:2 timestamp:20.5];
+  // Seeking back over a watched part adds nothing new.
+  [ranges addSampleWithCurrentTime:2 playbackRate:1 timestamp:21];
+  [ranges addSampleWithCurrentTime:2.5 playbackRate:1 timestamp:21.5];
+
+  XCTAssertEqual(ranges.rangeCount, 2);
+  XCTAssertEqual([ranges rangeAtIndex:0].start, 0);
+  XCTAssertEqual([ranges rangeAtIndex:0].end, 5);
+  XCTAssertEqual([ranges rangeAtIndex:1].start, 30);
+  XCTAssertEqual([ranges rangeAtIndex:1].end, 31.5);
+  XCTAssertFalse([ranges containsTime:10]);
+  XCTAssertEqualWithAccuracy(ranges.watchedFraction, 0.065, 1e-9);
+}
+
+- (void)testWatchedRangesFollowPlayer {
+  playerView.delegate = nil;
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  [self sendCallbackURL:@"ytplayer://onPlayTime?data=10&loaded=0.5&duration=100&rate=1"
+           toPlayerView:playerView];
+  XCTAssertEqual(playerView.watchedRanges.duration, 100);
+
+  // A new video starting clears what was watched of the previous one.
+  [playerView.watchedRanges addRangeFromTime:0 toTime:10];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=-1" toPlayerView:playerView];
+  XCTAssertEqual(playerView.watchedRanges.rangeCount, 0);
+}
+
+- (void)testWatchedRangesLongSessionPerformance {
+  [self measureBlock:^{
+    // Ten hours of play time reported twice a second, with a seek every ten minutes.
+    YTWatchedRanges *ranges = [[YTWatchedRanges alloc] init];
+    ranges.duration = 36000;
+    srand48(7);
+    double currentTime = 0;
+    for (int i = 0; i < 72000; i++) {
+      if (i % 1200 == 0) {
+        currentTime = drand48() * 36000;
+        [ranges interruptSampling];
+      }
+      [ranges addSampleWithCurrentTime:currentTime playbackRate:1 timestamp:i * 0.5];
+      currentTime += 0.5;
+      if (i % 100 == 0) {
+        XCTAssertLessThanOrEqual(ranges.watchedFraction, 1);
+      }
+    }
+  }];
+}
+
+#pragma mark - Circuit breaker
+
+- (void)testCircuitBreakerStates {
+  YTPlayerCircuitBreaker *breaker = [[YTPlayerCircuitBreaker alloc] init];
+  breaker.failureThreshold = 2;
+  breaker.cooldown = 10;
+
+  XCTAssertTrue([breaker shouldAttemptAtTime:0]);
+  [breaker recordFailureAtTime:1];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateClosed);
+  [breaker recordFailureAtTime:2];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateOpen);
+  XCTAssertFalse([breaker shouldAttemptAtTime:11.9]);
+
+  // After the cooldown a single probe goes through.
+  XCTAssertTrue([breaker shouldAttemptAtTime:12]);
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateHalfOpen);
+  XCTAssertFalse([breaker shouldAttemptAtTime:12.5]);
+
+  // A failed probe opens the breaker for another cooldown.
+  [breaker recordFailureAtTime:13];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateOpen);
+  XCTAssertFalse([breaker shouldAttemptAtTime:22]);
+
+  // An abandoned probe lets the next attempt probe.
+  XCTAssertTrue([breaker shouldAttemptAtTime:23]);
+  [breaker recordAbandonedAttempt];
+  XCTAssertTrue([breaker shouldAttemptAtTime:23.5]);
+
+  [breaker recordSuccess];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateClosed);
+  XCTAssertEqual(breaker.consecutiveFailureCount, 0);
+  XCTAssertTrue([breaker shouldAttemptAtTime:24]);
+}
+
+- (void)testCircuitBreakerAbandonsStalledProbe {
+  YTPlayerCircuitBreaker *breaker = [[YTPlayerCircuitBreaker alloc] init];
+  breaker.failureThreshold = 1;
+  breaker.cooldown = 10;
+  [breaker recordFailureAtTime:0];
+  XCTAssertTrue([breaker shouldAttemptAtTime:10]);
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateHalfOpen);
+
+  // The probe never reports. Other attempts fail fast until it has had a cooldown to do so.
+  XCTAssertFalse([breaker shouldAttemptAtTime:19.9]);
+  XCTAssertTrue([breaker shouldAttemptAtTime:20]);
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateHalfOpen);
+  XCTAssertFalse([breaker shouldAttemptAtTime:20.5]);
+
+  // The new probe decides as usual.
+  [breaker recordFailureAtTime:21];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateOpen);
+  XCTAssertFalse([breaker shouldAttemptAtTime:30.9]);
+}
+
+- (void)testCircuitBreakerIgnoresLateFailuresWhileOpen {
+  YTPlayerCircuitBreaker *breaker = [[YTPlayerCircuitBreaker alloc] init];
+  breaker.failureThreshold = 1;
+  breaker.cooldown = 10;
+  [breaker recordFailureAtTime:0];
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateOpen);
+
+  // Attempts started before the breaker opened fail later without extending the cooldown.
+  [breaker recordFailureAtTime:5];
+  [breaker recordFailureAtTime:9];
+  XCTAssertEqual(breaker.consecutiveFailureCount, 3u);
+  XCTAssertTrue([breaker shouldAttemptAtTime:10]);
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateHalfOpen);
+}
+
+- (void)testCircuitBreakerFailsLoadsFast {
+  YTPlayerCircuitBreaker *breaker = [[YTPlayerCircuitBreaker alloc] init];
+  breaker.failureThreshold = 2;
+  id delegate = OCMProtocolMock(@protocol(YTPlayerViewDelegate));
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  player.circuitBreaker = breaker;
+  player.delegate = delegate;
+
+  for (int i = 0; i < 2; i++) {
+    XCTAssertTrue([player loadWithVideoId:@"M7lc1UVf-VE"]);
+    [self sendCallbackURL:@"ytplayer://onYouTubeIframeAPIFailedToLoad?data=null"
+             toPlayerView:player];
+  }
+  XCTAssertEqual(breaker.state, kYTPlayerCircuitBreakerStateOpen);
+
+  WKWebView *failedWebView = player.webView;
+  OCMExpect([delegate playerView:player
+      didFailToLoadIframeAPIWithError:[OCMArg checkWithBlock:^BOOL(NSError *error) {
+        return [error.domain isEqualToString:YTPlayerViewErrorDomain] &&
+               error.code == kYTPlayerViewErrorIframeAPIUnavailable;
+      }]]);
+  XCTAssertFalse([player loadWithVideoId:@"M7lc1UVf-VE"]);
+  OCMVerifyAll(delegate);
+  // No web view was created for the refused load.
+  XCTAssertEqual(player.webView, failedWebView);
+
+  // A success, e.g. of another player's probe, lets loads through again.
+  [breaker recordSuccess];
+  XCTAssertTrue([player loadWithVideoId:@"M7lc1UVf-VE"]);
+  [self sendCallbackURL:@"ytplayer://onYouTubeIframeAPIReady?data=null" toPlayerView:player];
+  XCTAssertEqual(breaker.consecutiveFailureCount, 0);
+}
+
+#pragma mark - Speculative loading
+
+- (void)testSpeculativeLoadTracker {
+  YTSpeculativeLoadTracker *tracker = [[YTSpeculativeLoadTracker alloc] init];
+  NSUInteger tap = [tracker beginLoadAtTime:10];
+  NSUInteger scroll = [tracker beginLoadAtTime:11];
+  XCTAssertEqual(tracker.pendingLoadCount, 2);
+
+  XCTAssertTrue([tracker commitLoad:tap atTime:10.25]);
+  XCTAssertTrue([tracker cancelLoad:scroll]);
+  // Finished loads cannot finish again.
+  XCTAssertFalse([tracker cancelLoad:tap]);
+  XCTAssertFalse([tracker commitLoad:scroll atTime:12]);
+
+  XCTAssertEqual(tracker.pendingLoadCount, 0);
+  XCTAssertEqual(tracker.committedLoadCount, 1);
+  XCTAssertEqual(tracker.cancelledLoadCount, 1);
+  XCTAssertEqualWithAccuracy(tracker.wastedLoadFraction, 0.5, 1e-9);
+  XCTAssertEqualWithAccuracy(tracker.meanHeadStart, 0.25, 1e-9);
+}
+
+- (void)testSpeculativeLoadCommitAndCancel {
+  YTSpeculativeLoadTracker *tracker = [[YTSpeculativeLoadTracker alloc] init];
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  player.speculativeLoadTracker = tracker;
+
+  // Touch down: the video is cued speculatively, once however often intent is signaled.
+  XCTAssertTrue([player prepareToLoadWithVideoId:@"M7lc1UVf-VE" playerVars:nil]);
+  id preparedWebView = player.webView;
+  XCTAssertTrue([player prepareToLoadWithVideoId:@"M7lc1UVf-VE" playerVars:nil]);
+  XCTAssertEqual(player.webView, preparedWebView);
+  XCTAssertTrue(player.preparingLoad);
+
+  // Tap before the player is ready: it plays as soon as it is.
+  XCTAssertTrue([player commitPreparedLoad]);
+  XCTAssertFalse(player.preparingLoad);
+  [self sendCallbackURL:@"ytplayer://onReady?data=null" toPlayerView:player];
+  OCMVerify([preparedWebView evaluateJavaScript:@"player.playVideo();"
+                              completionHandler:[OCMArg any]]);
+
+  // Touch down that becomes a scroll: the page is torn down and the load counted as wasted.
+  XCTAssertTrue([player prepareToLoadWithVideoId:@"abc" playerVars:nil]);
+  [player cancelPreparedLoad];
+  XCTAssertNil(player.webView);
+  XCTAssertFalse([player commitPreparedLoad]);
+
+  XCTAssertEqual(tracker.committedLoadCount, 1);
+  XCTAssertEqual(tracker.cancelledLoadCount, 1);
+  XCTAssertEqualWithAccuracy(tracker.wastedLoadFraction, 0.5, 1e-9);
+}
+
+- (void)testSpeculativeLoadReplacedByLoad {
+  YTSpeculativeLoadTracker *tracker = [[YTSpeculativeLoadTracker alloc] init];
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  player.speculativeLoadTracker = tracker;
+
+  [player prepareToLoadWithVideoId:@"M7lc1UVf-VE" playerVars:nil];
+  [player loadWithVideoId:@"abc"];
+  XCTAssertFalse(player.preparingLoad);
+  XCTAssertEqual(tracker.cancelledLoadCount, 1);
+}
+
+#pragma mark - Logging
+
+// Counts how often log arguments are evaluated.
+static int gLogArgumentEvaluationCount = 0;
+
+static NSString *CountedLogArgument(void) {
+  gLogArgumentEvaluationCount++;
+  return @"argument";
+}
+
+- (void)testLogBufferKeepsMostRecentRecords {
+  YTPlayerLogBuffer *buffer = [[YTPlayerLogBuffer alloc] initWithCapacity:3];
+  buffer.label = @"p1";
+  for (int i = 0; i < 5; i++) {
+    [buffer addRecord:[[YTPlayerLogRecord alloc] initWithTimestamp:i
+                                                             level:kYTPlayerLogLevelInfo
+                                                           message:[@(i) stringValue]]];
+  }
+  XCTAssertEqual(buffer.count, 3);
+  NSArray *messages = [[buffer records] valueForKey:@"message"];
+  XCTAssertEqualObjects(messages, (@[ @"2", @"3", @"4" ]));
+  XCTAssertTrue([[buffer dump] hasPrefix:@"p1 [     2.000] I 2\n"]);
+
+  [buffer removeAllRecords];
+  XCTAssertEqual([buffer records].count, 0);
+}
+
+- (void)testLogLevelsAndLazyArguments {
+  YTPlayerLogLevel level = YTPlayerLogger.level;
+  YTPlayerLogBuffer *buffer = [[YTPlayerLogBuffer alloc] initWithCapacity:8];
+  YTPlayerLogger.level = kYTPlayerLogLevelWarning;
+  gLogArgumentEvaluationCount = 0;
+
+  YTPlayerLog(kYTPlayerLogLevelInfo, buffer, @"skipped %@", CountedLogArgument());
+  XCTAssertEqual(gLogArgumentEvaluationCount, 0);
+  XCTAssertEqual(buffer.count, 0);
+
+  YTPlayerLog(kYTPlayerLogLevelWarning, buffer, @"kept %@", CountedLogArgument());
+  XCTAssertEqual(gLogArgumentEvaluationCount, 1);
+  XCTAssertEqualObjects([buffer records].firstObject.message, @"kept argument");
+  XCTAssertEqual([buffer records].firstObject.level, kYTPlayerLogLevelWarning);
+
+  YTPlayerLogger.level = level;
+}
+
+- (void)testPlayerLogsEvents {
+  YTPlayerLogLevel level = YTPlayerLogger.level;
+  YTPlayerLogger.level = kYTPlayerLogLevelInfo;
+  playerView.delegate = nil;
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  XCTAssertEqualObjects([playerView.logBuffer records].lastObject.message, @"State changed to 1");
+  YTPlayerLogger.level = level;
+}
+
+- (void)testDisabledLogPerformance {
+  YTPlayerLogLevel level = YTPlayerLogger.level;
+  YTPlayerLogger.level = kYTPlayerLogLevelOff;
+  YTPlayerLogBuffer *buffer = [[YTPlayerLogBuffer alloc] initWithCapacity:64];
+  [self measureBlock:^{
+    for (int i = 0; i < 1000000; i++) {
+      YTPlayerLog(kYTPlayerLogLevelDebug, buffer, @"Event %@ %d", @"onPlayTime", i);
+    }
+  }];
+  YTPlayerLogger.level = level;
+}
+
+- (void)testEnabledLogPerformance {
+  YTPlayerLogLevel level = YTPlayerLogger.level;
+  YTPlayerLogLevel consoleLevel = YTPlayerLogger.consoleLevel;
+  YTPlayerLogger.level = kYTPlayerLogLevelDebug;
+  YTPlayerLogger.consoleLevel = kYTPlayerLogLevelOff;
+  YTPlayerLogBuffer *buffer = [[YTPlayerLogBuffer alloc] initWithCapacity:64];
+  [self measureBlock:^{
+    for (int i = 0; i < 100000; i++) {
+      YTPlayerLog(kYTPlayerLogLevelDebug, buffer, @"Event %@ %d", @"onPlayTime", i);
+    }
+  }];
+  YTPlayerLogger.level = level;
+  YTPlayerLogger.consoleLevel = consoleLevel;
+}
+
+#pragma mark - Frame-budgeted event dispatch
+
+// Returns a scheduler on a manual clock that is driven by calling processPendingEvents.
+- (YTBridgeEventScheduler *)manualEventSchedulerWithClock:(NSTimeInterval (^)(void))clock {
+  YTBridgeEventScheduler *scheduler = [[YTBridgeEventScheduler alloc] init];
+  scheduler.drivenByDisplayLink = NO;
+  scheduler.clock = clock;
+  return scheduler;
+}
+
+- (void)testEventSchedulerDefersPastBudget {
+  __block NSTimeInterval now = 100;
+  NSMutableArray *handled = [NSMutableArray array];
+  YTBridgeEventScheduler *scheduler = [self manualEventSchedulerWithClock:^NSTimeInterval {
+    return now;
+  }];
+  scheduler.frameBudget = 0.004;
+  BOOL (^schedule)(NSString *, YTBridgeEventPriority, NSString *) =
+      ^BOOL(NSString *event, YTBridgeEventPriority priority, NSString *coalescingKey) {
+        return [scheduler scheduleEventFromSource:self
+                                         priority:priority
+                                    coalescingKey:coalescingKey
+                                          handler:^{
+          [handled addObject:event];
+          now += 0.002;
+        }];
+      };
+
+  // Two events fit in the budget of the frame; the rest of the burst is queued.
+  XCTAssertFalse(schedule(@"state1", kYTBridgeEventPriorityNormal, nil));
+  XCTAssertFalse(schedule(@"time1", kYTBridgeEventPriorityLow, @"time"));
+  XCTAssertTrue(schedule(@"time2", kYTBridgeEventPriorityLow, @"time"));
+  XCTAssertTrue(schedule(@"state2", kYTBridgeEventPriorityNormal, nil));
+  XCTAssertTrue(schedule(@"time3", kYTBridgeEventPriorityLow, @"time"));
+  XCTAssertTrue(schedule(@"state3", kYTBridgeEventPriorityNormal, nil));
+  XCTAssertEqualObjects(handled, (@[ @"state1", @"time1" ]));
+  XCTAssertEqual(scheduler.pendingEventCount, 3);
+  XCTAssertEqual(scheduler.coalescedEventCount, 1);
+
+  // The next frames handle queued events in arrival order, the latest play time in place of
+  // the one it replaced.
+  now += 1.0 / 60;
+  XCTAssertTrue([scheduler processPendingEvents]);
+  XCTAssertEqualObjects(handled, (@[ @"state1", @"time1", @"state2", @"time3" ]));
+  now += 1.0 / 60;
+  XCTAssertFalse([scheduler processPendingEvents]);
+  XCTAssertEqualObjects(handled.lastObject, @"state3");
+  XCTAssertEqual(scheduler.deferredEventCount, 4);
+}
+
+- (void)testEventSchedulerSharesOneBudgetBetweenSources {
+  __block NSTimeInterval now = 100;
+  NSMutableArray *handled = [NSMutableArray array];
+  YTBridgeEventScheduler *scheduler = [self manualEventSchedulerWithClock:^NSTimeInterval {
+    return now;
+  }];
+  scheduler.frameBudget = 0.004;
+  NSObject *first = [[NSObject alloc] init];
+  BOOL (^schedule)(id, NSString *, YTBridgeEventPriority) =
+      ^BOOL(id source, NSString *event, YTBridgeEventPriority priority) {
+        return [scheduler scheduleEventFromSource:source
+                                         priority:priority
+                                    coalescingKey:@"time"
+                                          handler:^{
+          [handled addObject:event];
+          now += 0.002;
+        }];
+      };
+
+  @autoreleasepool {
+    NSObject *second = [[NSObject alloc] init];
+    // The sources do not get a budget each, and the same kind of report from another source is
+    // not coalesced with theirs.
+    XCTAssertFalse(schedule(first, @"first1", kYTBridgeEventPriorityLow));
+    XCTAssertFalse(schedule(second, @"second1", kYTBridgeEventPriorityLow));
+    XCTAssertTrue(schedule(first, @"first2", kYTBridgeEventPriorityLow));
+    XCTAssertTrue(schedule(second, @"second2", kYTBridgeEventPriorityLow));
+    XCTAssertEqual(scheduler.pendingEventCount, 2);
+    XCTAssertEqual(scheduler.coalescedEventCount, 0);
+    XCTAssertEqual([scheduler pendingEventCountFromSource:first], 1);
+  }
+
+  // The second source went away, and its queued events with it.
+  now += 1.0 / 60;
+  XCTAssertFalse([scheduler processPendingEvents]);
+  XCTAssertEqualObjects(handled, (@[ @"first1", @"second1", @"first2" ]));
+}
+
+- (void)testEventSchedulerHandlesOnlyTheSourcesQueueBeforeCriticalEvent {
+  __block NSTimeInterval now = 100;
+  NSMutableArray *handled = [NSMutableArray array];
+  YTBridgeEventScheduler *scheduler = [self manualEventSchedulerWithClock:^NSTimeInterval {
+    return now;
+  }];
+  NSObject *other = [[NSObject alloc] init];
+  BOOL (^schedule)(id, NSString *, YTBridgeEventPriority) =
+      ^BOOL(id source, NSString *event, YTBridgeEventPriority priority) {
+        return [scheduler scheduleEventFromSource:source
+                                         priority:priority
+                                    coalescingKey:nil
+                                          handler:^{
+          [handled addObject:event];
+          now += 0.005;
+        }];
+      };
+  schedule(self, @"buffering", kYTBridgeEventPriorityNormal);
+  XCTAssertTrue(schedule(other, @"other", kYTBridgeEventPriorityNormal));
+  XCTAssertTrue(schedule(self, @"playing", kYTBridgeEventPriorityNormal));
+
+  // The end of playback is handled right away, after what its source sent before it but
+  // without handling the backlog of other sources.
+  XCTAssertFalse(schedule(self, @"ended", kYTBridgeEventPriorityCritical));
+  XCTAssertEqualObjects(handled, (@[ @"buffering", @"playing", @"ended" ]));
+  XCTAssertEqual(scheduler.pendingEventCount, 1);
+  XCTAssertEqual([scheduler pendingEventCountFromSource:other], 1);
+}
+
+- (void)testEventSchedulerHandlesOneEventPerFrameAtLeast {
+  __block NSTimeInterval now = 0;
+  __block int handledCount = 0;
+  YTBridgeEventScheduler *scheduler = [self manualEventSchedulerWithClock:^NSTimeInterval {
+    return now;
+  }];
+  for (int i = 0; i < 3; i++) {
+    [scheduler scheduleEventFromSource:self
+                              priority:kYTBridgeEventPriorityNormal
+                         coalescingKey:nil
+                               handler:^{
+      handledCount++;
+      now += 0.010;
+    }];
+  }
+  XCTAssertEqual(handledCount, 1);
+  XCTAssertTrue([scheduler processPendingEvents]);
+  XCTAssertEqual(handledCount, 2);
+  [scheduler removeAllEventsFromSource:self];
+  XCTAssertFalse([scheduler processPendingEvents]);
+  XCTAssertEqual(handledCount, 2);
+}
+
+- (void)testBudgetedPlayerReportsEndedAfterQueuedStateChange {
+  YTBridgeEventScheduler *scheduler = [[YTBridgeEventScheduler alloc] init];
+  scheduler.drivenByDisplayLink = NO;
+  scheduler.frameBudget = 1e-9;
+  // Keep the test in the frame interval the first event spends the budget of.
+  scheduler.frameInterval = 1e6;
+  playerView.eventScheduler = scheduler;
+  [mockDelegate setExpectationOrderMatters:YES];
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStateBuffering];
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStatePlaying];
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStateEnded];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=3" toPlayerView:playerView];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  XCTAssertEqual([scheduler pendingEventCountFromSource:playerView], 1);
+
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=0" toPlayerView:playerView];
+  [mockDelegate verify];
+  XCTAssertEqual(playerView.lastReportedState, kYTPlayerStateEnded);
+  XCTAssertEqual(scheduler.pendingEventCount, 0);
+}
+
+- (void)testBudgetedPlayerDeliversEventsWithoutBacklog {
+  playerView.eventScheduler = [[YTBridgeEventScheduler alloc] init];
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStatePlaying];
+  [[mockDelegate expect] playerView:playerView receivedError:kYTPlayerErrorHTML5Error];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  [self sendCallbackURL:@"ytplayer://onError?data=5" toPlayerView:playerView];
+  [mockDelegate verify];
+}
+
+#pragma mark - Command effects
+
+- (void)testCommandEffectObservedAfterIntermediateStates {
+  YTScriptedPlayer *player = [[YTScriptedPlayer alloc] init];
+  __block NSInteger calls = 0;
+  __block YTCommandEffectResult result = kYTCommandEffectTimedOut;
+  __block NSTimeInterval latency = 0;
+  [player.tracker trackCommand:kYTTrackedCommandPlay
+                expectingState:kYTPlayerStatePlaying
+                        atTime:player.now
+                       handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                         calls++;
+                         result = r;
+                         latency = l;
+                       }];
+  [player reportState:kYTPlayerStateBuffering after:0.2];
+  [player reportState:kYTPlayerStatePlaying after:0.35];
+  [player advanceBy:0.3];
+  XCTAssertEqual(calls, 0);
+  XCTAssertEqual(player.tracker.pendingCommandCount, 1);
+
+  [player advanceBy:1];
+  XCTAssertEqual(calls, 1);
+  XCTAssertEqual(result, kYTCommandEffectObserved);
+  XCTAssertEqualWithAccuracy(latency, 0.35, 1e-9);
+  YTCommandEffectStatistics statistics =
+      [player.tracker statisticsForCommand:kYTTrackedCommandPlay];
+  XCTAssertEqual(statistics.observedCount, 1);
+  XCTAssertEqualWithAccuracy(statistics.meanLatency, 0.35, 1e-9);
+  XCTAssertEqualWithAccuracy(statistics.maxLatency, 0.35, 1e-9);
+  XCTAssertTrue(isnan([player.tracker statisticsForCommand:kYTTrackedCommandPause].meanLatency));
+
+  // Playing a playing video changes nothing, so it takes effect right away.
+  [player.tracker trackCommand:kYTTrackedCommandPlay
+                expectingState:kYTPlayerStatePlaying
+                        atTime:player.now
+                       handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                         calls++;
+                         result = r;
+                         latency = l;
+                       }];
+  XCTAssertEqual(calls, 2);
+  XCTAssertEqual(result, kYTCommandEffectObserved);
+  XCTAssertEqual(latency, 0);
+}
+
+- (void)testCommandEffectSeekMatchesNearbyPlayTime {
+  YTScriptedPlayer *player = [[YTScriptedPlayer alloc] init];
+  __block YTCommandEffectResult result = kYTCommandEffectTimedOut;
+  __block NSTimeInterval latency = 0;
+  [player.tracker trackSeekToSeconds:30
+                              atTime:player.now
+                             handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                               result = r;
+                               latency = l;
+                             }];
+  // A report sent before the seek landed, then one from after it.
+  [player reportPlayTime:12.4 after:0.1];
+  [player reportPlayTime:30.6 after:0.6];
+  [player advanceBy:0.5];
+  XCTAssertEqual(player.tracker.pendingCommandCount, 1);
+  [player advanceBy:0.5];
+  XCTAssertEqual(player.tracker.pendingCommandCount, 0);
+  XCTAssertEqual(result, kYTCommandEffectObserved);
+  XCTAssertEqualWithAccuracy(latency, 0.6, 1e-9);
+}
+
+- (void)testCommandEffectTimesOut {
+  YTScriptedPlayer *player = [[YTScriptedPlayer alloc] init];
+  player.tracker.timeout = 2;
+  __block YTCommandEffectResult result = kYTCommandEffectObserved;
+  [player.tracker trackCommand:kYTTrackedCommandCue
+                expectingState:kYTPlayerStateCued
+                        atTime:player.now
+                       handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                         result = r;
+                       }];
+  [player reportState:kYTPlayerStateUnstarted after:0.5];
+  [player advanceBy:1.5];
+  XCTAssertEqual(player.tracker.pendingCommandCount, 1);
+  [player advanceBy:0.5];
+  XCTAssertEqual(player.tracker.pendingCommandCount, 0);
+  XCTAssertEqual(result, kYTCommandEffectTimedOut);
+  XCTAssertEqual([player.tracker statisticsForCommand:kYTTrackedCommandCue].timedOutCount, 1);
+}
+
+- (void)testCommandEffectSupersededAndCancelled {
+  YTScriptedPlayer *player = [[YTScriptedPlayer alloc] init];
+  NSMutableArray<NSString *> *results = [NSMutableArray array];
+  YTCommandEffectHandler (^record)(NSString *) = ^(NSString *name) {
+    return ^(YTCommandEffectResult r, NSTimeInterval l) {
+      [results addObject:[NSString stringWithFormat:@"%@:%ld", name, (long)r]];
+    };
+  };
+  YTCommandEffectTracker *tracker = player.tracker;
+  [tracker trackCommand:kYTTrackedCommandPause
+         expectingState:kYTPlayerStatePaused
+                 atTime:player.now
+                handler:record(@"pause")];
+  [tracker trackSeekToSeconds:10 atTime:player.now handler:record(@"seek")];
+  [tracker trackCommand:kYTTrackedCommandPlay
+         expectingState:kYTPlayerStatePlaying
+                 atTime:player.now
+                handler:record(@"play")];
+  XCTAssertEqualObjects(results, @[ @"pause:2" ]);
+
+  // Cueing replaces the video, so nothing pending can take effect any more.
+  [tracker trackCommand:kYTTrackedCommandCue
+         expectingState:kYTPlayerStateCued
+                 atTime:player.now
+                handler:record(@"cue")];
+  XCTAssertEqualObjects(results, (@[ @"pause:2", @"seek:2", @"play:2" ]));
+
+  [tracker cancelAllCommandsAtTime:player.now];
+  XCTAssertEqualObjects(results.lastObject, @"cue:3");
+  XCTAssertEqual(tracker.pendingCommandCount, 0);
+  XCTAssertEqual([tracker statisticsForCommand:kYTTrackedCommandPause].abandonedCount, 1);
+  [tracker resetStatistics];
+  XCTAssertEqual([tracker statisticsForCommand:kYTTrackedCommandPause].abandonedCount, 0);
+}
+
+- (void)testCommandEffectHandlerMaySendCommands {
+  YTScriptedPlayer *player = [[YTScriptedPlayer alloc] init];
+  YTCommandEffectTracker *tracker = player.tracker;
+  __block BOOL seekObserved = NO;
+  [tracker trackCommand:kYTTrackedCommandPlay
+         expectingState:kYTPlayerStatePlaying
+                 atTime:player.now
+                handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                  [tracker trackSeekToSeconds:42
+                                       atTime:player.now
+                                      handler:^(YTCommandEffectResult r, NSTimeInterval l) {
+                                        seekObserved = r == kYTCommandEffectObserved;
+                                      }];
+                }];
+  [player reportState:kYTPlayerStatePlaying after:0.1];
+  [player reportPlayTime:42.2 after:0.6];
+  [player advanceBy:1];
+  XCTAssertTrue(seekObserved);
+}
+
+- (void)testPlayVideoCompletesWhenPageReportsPlaying {
+  [[mockWebView expect] evaluateJavaScript:@"player.playVideo();" completionHandler:[OCMArg any]];
+  __block NSInteger calls = 0;
+  [playerView playVideoWithCompletionHandler:^(YTCommandEffectResult result,
+                                               NSTimeInterval latency) {
+    XCTAssertEqual(result, kYTCommandEffectObserved);
+    calls++;
+  }];
+  [mockWebView verify];
+  XCTAssertEqual(calls, 0);
+
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStatePlaying];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:playerView];
+  [mockDelegate verify];
+  XCTAssertEqual(calls, 1);
+  XCTAssertEqual([playerView.commandEffectTracker
+                     statisticsForCommand:kYTTrackedCommandPlay].observedCount, 1);
+}
+
+- (void)testPauseVideoIgnoresLocallyReportedState {
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStatePaused];
+  [[mockWebView expect] evaluateJavaScript:@"player.pauseVideo();" completionHandler:[OCMArg any]];
+  __block NSInteger calls = 0;
+  [playerView pauseVideoWithCompletionHandler:^(YTCommandEffectResult result,
+                                                NSTimeInterval latency) {
+    calls++;
+  }];
+  [mockWebView verify];
+  [mockDelegate verify];
+  XCTAssertEqual(calls, 0);
+
+  [[mockDelegate expect] playerView:playerView didChangeToState:kYTPlayerStatePaused];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=2" toPlayerView:playerView];
+  XCTAssertEqual(calls, 1);
+}
+
+#pragma mark - Spherical video controls
+
+- (void)testSphericalPropertiesAreCoalescedPerFrame {
+  [[mockWebView expect] evaluateJavaScript:@"player.setSphericalProperties("
+                                            "{yaw: 90.000000, pitch: 10.000000, roll: 0.000000, fov: 100.000000});"
+                         completionHandler:[OCMArg any]];
+  for (int i = 0; i <= 90; i++) {
+    YTSphericalProperties properties = { .yaw = i, .pitch = 10, .roll = 0, .fieldOfView = 100 };
+    [playerView setSphericalProperties:properties];
+  }
+  [playerView flushSphericalProperties:nil];
+  // Nothing is pending anymore, so the next frame must not evaluate anything.
+  [playerView flushSphericalProperties:nil];
+  [mockWebView verify];
+  [playerView stopSphericalDisplayLink];
+}
+
+- (void)testSphericalPropertiesMirror {
+  NSURL *url = [NSURL URLWithString:@"ytplayer://onSphericalPropertiesChange?data=45,-10,5,90"];
+  NSURLRequest *request = [[NSURLRequest alloc] initWithURL:url];
+
+  id actionMock = [OCMockObject mockForClass:[WKNavigationAction class]];
+  OCMStub([actionMock request]).andReturn(request);
+
+  [(id<WKNavigationDelegate>) playerView webView:mockWebView decidePolicyForNavigationAction:actionMock decisionHandler:^(WKNavigationActionPolicy decision) {}];
+
+  XCTAssertEqual(playerView.sphericalProperties.yaw, 45);
+  XCTAssertEqual(playerView.sphericalProperties.pitch, -10);
+  XCTAssertEqual(playerView.sphericalProperties.roll, 5);
+  XCTAssertEqual(playerView.sphericalProperties.fieldOfView, 90);
+}
+
 #pragma mark - Tests for cueing and loading videos
 
 - (void)testCueVideoByIdstartSeconds {
@@ -230,6 +1597,410 @@
   [mockWebView verify];
 }
 
+#pragma mark - Packed video IDs
+
+- (void)testVideoIdPacking {
+  for (NSString *string in @[ @"M7lc1UVf-VE", @"dQw4w9WgXcQ", @"AAAAAAAAAAA", @"__________8" ]) {
+    YTVideoId *videoId = [YTVideoId videoIdWithString:string];
+    XCTAssertNotNil(videoId, @"%@", string);
+    XCTAssertEqualObjects(videoId.stringValue, string);
+    XCTAssertEqualObjects([[YTVideoId alloc] initWithPackedValue:videoId.packedValue], videoId);
+  }
+  XCTAssertEqual([YTVideoId videoIdWithString:@"AAAAAAAAAAA"].packedValue, 0);
+  XCTAssertEqual([YTVideoId videoIdWithString:@"__________8"].packedValue, UINT64_MAX);
+
+  // Wrong length, characters outside the alphabet, and a last character carrying low bits.
+  for (NSString *string in @[ @"", @"abc", @"M7lc1UVf-VEX", @"M7lc1UVf+VE", @"M7lc1UVf-VF",
+                              @"M7lc1UVf-V\u00e9" ]) {
+    XCTAssertNil([YTVideoId videoIdWithString:string], @"%@", string);
+  }
+  XCTAssertNil([YTVideoId videoIdWithString:nil]);
+
+  YTVideoId *first = [YTVideoId videoIdWithString:@"AAAAAAAAAAE"];
+  YTVideoId *second = [YTVideoId videoIdWithString:@"AAAAAAAAABA"];
+  XCTAssertEqual([first compare:second], NSOrderedAscending);
+  XCTAssertEqual([second compare:first], NSOrderedDescending);
+  XCTAssertEqual([first compare:[first copy]], NSOrderedSame);
+  XCTAssertEqual([YTVideoId videoIdWithString:@"M7lc1UVf-VE"].hash,
+                 [YTVideoId videoIdWithString:@"M7lc1UVf-VE"].hash);
+}
+
+- (void)testPlayQueueContainsVideoId {
+  YTPlayQueue *queue = [[YTPlayQueue alloc] init];
+  YTPlayQueueItem *packed = [[YTPlayQueueItem alloc] initWithVideoId:@"M7lc1UVf-VE"];
+  [queue appendItem:packed];
+  [queue appendItem:[[YTPlayQueueItem alloc] initWithVideoId:@"abc"]];
+  [queue appendItem:[[YTPlayQueueItem alloc] initWithVideoId:@"M7lc1UVf-VE"]];
+  XCTAssertEqualObjects(packed.videoId, @"M7lc1UVf-VE");
+  XCTAssertTrue([queue containsVideoId:@"M7lc1UVf-VE"]);
+  XCTAssertTrue([queue containsVideoId:@"abc"]);
+  XCTAssertFalse([queue containsVideoId:@"dQw4w9WgXcQ"]);
+
+  // The ID stays in the queue until its last item is removed.
+  [queue removeItem:packed];
+  XCTAssertTrue([queue containsVideoId:@"M7lc1UVf-VE"]);
+  [queue removeAllItems];
+  XCTAssertFalse([queue containsVideoId:@"M7lc1UVf-VE"]);
+}
+
+// Random well-formed video IDs for the hash map benchmarks.
+- (NSArray<NSString *> *)randomVideoIdStrings:(NSUInteger)count {
+  static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+  srand48(11);
+  NSMutableArray<NSString *> *strings = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    unichar characters[11];
+    for (int c = 0; c < 10; c++) {
+      characters[c] = alphabet[(int)(drand48() * 64)];
+    }
+    characters[10] = alphabet[(int)(drand48() * 16) * 4];
+    [strings addObject:[NSString stringWithCharacters:characters length:11]];
+  }
+  return strings;
+}
+
+// IDs arriving from the page are new strings, so both benchmarks look up copies and neither can
+// compare pointers; the packed IDs are parsed from them as YTPlayQueue::containsVideoId: does.
+- (NSArray<NSString *> *)copiesOfStrings:(NSArray<NSString *> *)strings {
+  NSMutableArray<NSString *> *copies = [NSMutableArray arrayWithCapacity:strings.count];
+  for (NSString *string in strings) {
+    [copies addObject:[string mutableCopy]];
+  }
+  return copies;
+}
+
+- (void)testVideoIdDictionaryPerformance {
+  NSArray<NSString *> *strings = [self randomVideoIdStrings:20000];
+  NSArray<NSString *> *lookups = [self copiesOfStrings:strings];
+  [self measureBlock:^{
+    NSMutableDictionary<YTVideoId *, NSNumber *> *cache = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < strings.count; i++) {
+      cache[[YTVideoId videoIdWithString:strings[i]]] = @(i);
+    }
+    for (int round = 0; round < 5; round++) {
+      for (NSString *videoId in lookups) {
+        XCTAssertNotNil(cache[[YTVideoId videoIdWithString:videoId]]);
+      }
+    }
+  }];
+}
+
+- (void)testVideoIdStringDictionaryPerformance {
+  NSArray<NSString *> *strings = [self randomVideoIdStrings:20000];
+  NSArray<NSString *> *lookups = [self copiesOfStrings:strings];
+  [self measureBlock:^{
+    NSMutableDictionary<NSString *, NSNumber *> *cache = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < strings.count; i++) {
+      cache[strings[i]] = @(i);
+    }
+    for (int round = 0; round < 5; round++) {
+      for (NSString *videoId in lookups) {
+        XCTAssertNotNil(cache[videoId]);
+      }
+    }
+  }];
+}
+
+#pragma mark - Play queue
+
+- (void)testPlayQueueEditing {
+  YTPlayQueue *queue = [[YTPlayQueue alloc] init];
+  YTPlayQueueItem *a = [[YTPlayQueueItem alloc] initWithVideoId:@"a"];
+  YTPlayQueueItem *b = [[YTPlayQueueItem alloc] initWithVideoId:@"b"];
+  YTPlayQueueItem *c = [[YTPlayQueueItem alloc] initWithVideoId:@"c"];
+  YTPlayQueueItem *d = [[YTPlayQueueItem alloc] initWithVideoId:@"d"];
+  [queue appendItem:a];
+  [queue appendItem:c];
+  [queue insertItem:b afterItem:a];
+  [queue insertItem:d beforeItem:a];
+  XCTAssertEqualObjects([queue allItems], (@[ d, a, b, c ]));
+
+  [queue moveItem:d afterItem:c];
+  [queue moveItem:c afterItem:nil];
+  XCTAssertEqualObjects([queue allItems], (@[ c, a, b, d ]));
+  XCTAssertEqual(queue.lastItem, d);
+
+  [queue setCurrentItem:a];
+  XCTAssertEqual(queue.upNextItem, b);
+  // Removing the playing item keeps its successor up next.
+  [queue removeItem:a];
+  XCTAssertNil(queue.currentItem);
+  XCTAssertEqual(queue.upNextItem, b);
+  [queue removeItem:b];
+  XCTAssertEqual(queue.upNextItem, d);
+  XCTAssertEqual([queue advance], d);
+  XCTAssertNil([queue advance]);
+  XCTAssertEqual(queue.count, 1u);
+  XCTAssertEqualObjects([queue allItems], (@[ c ]));
+}
+
+- (void)testPlayQueueRapidEditsOnLargeQueue {
+  YTPlayQueue *queue = [[YTPlayQueue alloc] init];
+  NSMutableArray<YTPlayQueueItem *> *items = [NSMutableArray array];
+  for (int i = 0; i < 100000; i++) {
+    YTPlayQueueItem *item =
+        [[YTPlayQueueItem alloc] initWithVideoId:[NSString stringWithFormat:@"%d", i]];
+    [queue appendItem:item];
+    [items addObject:item];
+  }
+  [queue setCurrentItem:items[50000]];
+  for (int i = 0; i < 50000; i += 2) {
+    [queue removeItem:items[i]];
+    [queue moveItem:items[i + 1] afterItem:queue.lastItem];
+  }
+  XCTAssertEqual(queue.count, 75000u);
+  XCTAssertEqual(queue.firstItem, items[50000]);
+  XCTAssertEqual(queue.lastItem, items[49999]);
+  XCTAssertEqual(queue.upNextItem, items[50001]);
+  [queue removeAllItems];
+  XCTAssertEqual(queue.count, 0u);
+}
+
+- (void)testPlayQueueLoadsNextItemWhenVideoEnds {
+  YTPlayQueue *queue = [[YTPlayQueue alloc] init];
+  YTPlayQueueItem *first = [[YTPlayQueueItem alloc] initWithVideoId:@"abc"];
+  [queue appendItem:first];
+  [queue appendItem:[[YTPlayQueueItem alloc] initWithVideoId:@"def"
+                                                startSeconds:5.5
+                                                  endSeconds:10.5]];
+  [queue setCurrentItem:first];
+  playerView.playQueue = queue;
+
+  [[mockDelegate stub] playerView:[OCMArg any] didChangeToState:kYTPlayerStateEnded];
+  [[mockWebView expect] evaluateJavaScript:@"player.loadVideoById({'videoId': 'def',"
+                                            "'startSeconds': 5.5, 'endSeconds': 10.5});"
+                         completionHandler:[OCMArg any]];
+
+  NSURL *url = [NSURL URLWithString:@"ytplayer://onStateChange?data=0"];
+  NSURLRequest *request = [[NSURLRequest alloc] initWithURL:url];
+  id actionMock = [OCMockObject mockForClass:[WKNavigationAction class]];
+  OCMStub([actionMock request]).andReturn(request);
+  [(id<WKNavigationDelegate>) playerView webView:mockWebView decidePolicyForNavigationAction:actionMock decisionHandler:^(WKNavigationActionPolicy decision) {}];
+
+  [mockWebView verify];
+}
+
+#pragma mark - Autoplay selection
+
+- (void)testAutoplaySelectorHysteresisAndDwellTime {
+  id playerA = OCMStrictClassMock([YTPlayerView class]);
+  id playerB = OCMStrictClassMock([YTPlayerView class]);
+  YTAutoplaySelector *selector = [[YTAutoplaySelector alloc] init];
+  [selector registerPlayerView:playerA];
+  [selector registerPlayerView:playerB];
+
+  // A becomes the best candidate but has to wait out the dwell time.
+  [selector setVisibleFraction:0.9 forPlayerView:playerA];
+  [selector setVisibleFraction:0.2 forPlayerView:playerB];
+  [selector updateAtTime:0];
+  XCTAssertNil(selector.activePlayerView);
+
+  [[playerA expect] playVideo];
+  [selector updateAtTime:0.35];
+  [playerA verify];
+  XCTAssertEqual(selector.activePlayerView, playerA);
+
+  // B is slightly more visible, which is within the switch margin.
+  [selector setVisibleFraction:0.6 forPlayerView:playerA];
+  [selector setVisibleFraction:0.7 forPlayerView:playerB];
+  [selector updateAtTime:0.4];
+
+  // B pulls ahead, then falls back before its dwell time has elapsed.
+  [selector setVisibleFraction:0.5 forPlayerView:playerA];
+  [selector setVisibleFraction:0.7 forPlayerView:playerB];
+  [selector updateAtTime:0.5];
+  [selector setVisibleFraction:0.6 forPlayerView:playerA];
+  [selector setVisibleFraction:0.65 forPlayerView:playerB];
+  [selector updateAtTime:0.9];
+  XCTAssertEqual(selector.activePlayerView, playerA);
+
+  // A scrolls out of view and is paused right away; B starts after its dwell time.
+  [[playerA expect] pauseVideo];
+  [selector setVisibleFraction:0.3 forPlayerView:playerA];
+  [selector setVisibleFraction:0.9 forPlayerView:playerB];
+  [selector updateAtTime:1.0];
+  [playerA verify];
+  XCTAssertNil(selector.activePlayerView);
+
+  [[playerB expect] playVideo];
+  [selector updateAtTime:1.3];
+  [playerB verify];
+  XCTAssertEqual(selector.activePlayerView, playerB);
+}
+
+#pragma mark - Memory budget
+
+- (void)sendCallbackURL:(NSString *)urlString toPlayerView:(YTPlayerView *)player {
+  NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:urlString]];
+  id actionMock = OCMClassMock([WKNavigationAction class]);
+  OCMStub([actionMock request]).andReturn(request);
+  [(id<WKNavigationDelegate>)player webView:player.webView
+            decidePolicyForNavigationAction:actionMock
+                            decisionHandler:^(WKNavigationActionPolicy decision) {}];
+}
+
+- (void)testBudgetManagerEvictsCheapestToRestoreFirst {
+  YTPlayerBudgetManager *manager = [[YTPlayerBudgetManager alloc] init];
+  manager.budget = 3.5;
+  NSMutableArray<YTPlayerView *> *players = [NSMutableArray array];
+  for (NSInteger i = 0; i < 4; i++) {
+    YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+    [player loadWithVideoId:@"M7lc1UVf-VE"];
+    [manager registerPlayerView:player];
+    [manager notePlayerViewUsed:player atTime:i];
+    [players addObject:player];
+  }
+  // 0 and 1 are off screen and paused, 2 is off screen and playing, 3 is on screen and playing.
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:players[2]];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:players[3]];
+  [manager setVisible:YES forPlayerView:players[3]];
+  XCTAssertEqualWithAccuracy(manager.totalCost, 6.25, 1e-9);
+
+  NSArray<YTPlayerView *> *evicted = [manager enforceBudget];
+  NSArray<YTPlayerView *> *expected = @[ players[0], players[1], players[2] ];
+  XCTAssertEqualObjects(evicted, expected);
+  XCTAssertTrue(players[0].hibernating);
+  XCTAssertFalse(players[3].hibernating);
+  XCTAssertEqualWithAccuracy(manager.totalCost, 2.25, 1e-9);
+
+  // Restoring 0 makes room for it without evicting it right back.
+  XCTAssertTrue([manager restorePlayerView:players[0] atTime:10]);
+  XCTAssertFalse(players[0].hibernating);
+  XCTAssertNotNil(players[0].webView);
+  XCTAssertEqualWithAccuracy(manager.totalCost, 3.25, 1e-9);
+
+  // A memory warning spares only the player that is both visible and playing.
+  evicted = [manager handleMemoryWarning];
+  XCTAssertEqualObjects(evicted, @[ players[0] ]);
+  XCTAssertEqualWithAccuracy(manager.totalCost, 2.25, 1e-9);
+}
+
+- (void)testHibernatedPlayerResumesWhereItLeftOff {
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  [player loadWithVideoId:@"M7lc1UVf-VE"];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=1" toPlayerView:player];
+  [self sendCallbackURL:@"ytplayer://onPlayTime?data=42.5&loaded=0.5&duration=300&rate=1.5"
+           toPlayerView:player];
+
+  [player hibernate];
+  XCTAssertTrue(player.hibernating);
+  XCTAssertNil(player.webView);
+
+  XCTAssertTrue([player restoreFromHibernation]);
+  XCTAssertFalse(player.hibernating);
+  OCMVerify([player.webView loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+    return [html containsString:@"\"seekToSeconds\":42.5"] &&
+           [html containsString:@"\"playbackRate\":1.5"] &&
+           [html containsString:@"\"playVideo\":true"];
+  }] baseURL:[OCMArg any]]);
+  XCTAssertFalse([player restoreFromHibernation]);
+}
+
+- (void)testHibernatedPlayerRestoresPlayQueueAdvance {
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  player.playQueue = [[YTPlayQueue alloc] init];
+  YTPlayQueueItem *first = [[YTPlayQueueItem alloc] initWithVideoId:@"M7lc1UVf-VE"];
+  [player.playQueue appendItem:first];
+  [player.playQueue appendItem:[[YTPlayQueueItem alloc] initWithVideoId:@"9bZkp7q19f0"]];
+  [player.playQueue setCurrentItem:first];
+  [player loadWithVideoId:@"M7lc1UVf-VE"];
+
+  // The first video ends and the queue loads the next one into the same player.
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=0" toPlayerView:player];
+  XCTAssertTrue([player hibernate]);
+  XCTAssertFalse([player hibernate]);
+
+  XCTAssertTrue([player restoreFromHibernation]);
+  OCMVerify([player.webView loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+    return [html containsString:@"\"videoId\":\"9bZkp7q19f0\""] &&
+           ![html containsString:@"M7lc1UVf-VE"];
+  }] baseURL:[OCMArg any]]);
+}
+
+- (void)testHibernatedPlayerRestoresPlaylistPositionReportedByPage {
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  [player loadWithPlaylistId:@"PLhBgTdAWkxeCMHYCQ0uuLyhydRJGDRNo5"];
+
+  // The page reports where the next video took the player along with the state change.
+  JSContext *context = [self bridgeContext];
+  [context evaluateScript:
+      @"createPlayerEventHandlers(sendEvent, null, null).onStateChange({"
+       "  target: {"
+       "    getVideoUrl: function() { return 'https://www.youtube.com/watch?v=9bZkp7q19f0'; },"
+       "    getPlaylistIndex: function() { return 2; }"
+       "  },"
+       "  data: 1"
+       "});"];
+  NSString *event = [[context[@"sentEvents"] toArray] firstObject];
+  XCTAssertEqualObjects(event, @"ytplayer://onStateChange?data=1&video=9bZkp7q19f0&index=2");
+  [self sendCallbackURL:event toPlayerView:player];
+
+  XCTAssertTrue([player hibernate]);
+  XCTAssertTrue([player restoreFromHibernation]);
+  OCMVerify([player.webView loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+    return [html containsString:@"\"list\":\"PLhBgTdAWkxeCMHYCQ0uuLyhydRJGDRNo5\""] &&
+           [html containsString:@"\"playlist\":\"PLhBgTdAWkxeCMHYCQ0uuLyhydRJGDRNo5\""] &&
+           [html containsString:@"\"playlistIndex\":2"] &&
+           [html containsString:@"\"playVideo\":true"];
+  }] baseURL:[OCMArg any]]);
+}
+
+- (void)testHibernatedPausedPlaylistPlayerIsCuedAtItsPosition {
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  [player loadWithVideoId:@"M7lc1UVf-VE"];
+  [player cuePlaylistByVideos:@[ @"M7lc1UVf-VE", @"9bZkp7q19f0", @"dQw4w9WgXcQ" ]
+                        index:1
+                 startSeconds:0];
+  [self sendCallbackURL:@"ytplayer://onStateChange?data=2&video=9bZkp7q19f0&index=1"
+           toPlayerView:player];
+  [self sendCallbackURL:@"ytplayer://onPlayTime?data=12.5&loaded=0.5&duration=300&rate=1"
+           toPlayerView:player];
+
+  XCTAssertTrue([player hibernate]);
+  XCTAssertTrue([player restoreFromHibernation]);
+  OCMVerify([player.webView loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+    return [html containsString:@"\"playlist\":[\"M7lc1UVf-VE\",\"9bZkp7q19f0\",\"dQw4w9WgXcQ\"]"] &&
+           [html containsString:@"\"playlistIndex\":1"] &&
+           [html containsString:@"\"seekToSeconds\":12.5"] &&
+           ![html containsString:@"\"playVideo\""];
+  }] baseURL:[OCMArg any]]);
+
+  // The page cues the playlist at the index and time in one command instead of playing it.
+  JSContext *context = [self bridgeContext];
+  [context evaluateScript:
+      @"var calls = [];"
+       "var target = {};"
+       "['cuePlaylist', 'loadPlaylist', 'playVideoAt', 'seekTo', 'playVideo'].forEach("
+       "    function(name) {"
+       "      target[name] = function() {"
+       "        calls.push(name + JSON.stringify(Array.prototype.slice.call(arguments)));"
+       "      };"
+       "    });"
+       "applyInitialState(target, {playlist: ['a', 'b'], playlistIndex: 1, seekToSeconds: 12.5});"];
+  XCTAssertEqualObjects([context[@"calls"] toArray], @[ @"cuePlaylist[[\"a\",\"b\"],1,12.5]" ]);
+}
+
+- (void)testBudgetManagerDestroysPlayerThatCannotHibernate {
+  YTPlayerBudgetManager *manager = [[YTPlayerBudgetManager alloc] init];
+  manager.budget = 0;
+  id delegate = OCMProtocolMock(@protocol(YTPlayerBudgetManagerDelegate));
+  manager.delegate = delegate;
+  // A web view into which nothing was loaded cannot be hibernated.
+  YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+  [player setWebView:[player createNewWebView]];
+  [manager registerPlayerView:player];
+  XCTAssertGreaterThan(manager.totalCost, 0);
+
+  XCTAssertEqualObjects([manager enforceBudget], @[ player ]);
+  OCMVerify([delegate budgetManager:manager
+                 didEvictPlayerView:player
+                         withAction:kYTPlayerEvictionActionDestroy]);
+  XCTAssertFalse(player.hibernating);
+  XCTAssertNil(player.webView);
+  XCTAssertEqual(manager.totalCost, 0);
+}
+
 #pragma mark - Retrieving playlist information
 
 - (void)testGetPlaylist {
@@ -294,6 +2065,73 @@
   [mockDelegate verify];
 }
 
+- (void)testOnPlaybackRateChangeCallback {
+  [[mockDelegate expect] playerView:playerView didChangeToPlaybackRate:1.5f];
+  [self sendCallbackURL:@"ytplayer://onPlaybackRateChange?data=1.5" toPlayerView:playerView];
+  [mockDelegate verify];
+}
+
+- (void)testOnApiChangeCallback {
+  [[mockDelegate expect] playerView:playerView didChangeAPIModules:@[ @"captions", @"cc" ]];
+  [self sendCallbackURL:@"ytplayer://onApiChange?data=captions%2Ccc" toPlayerView:playerView];
+  [mockDelegate verify];
+
+  [[mockDelegate expect] playerView:playerView didChangeAPIModules:@[]];
+  [self sendCallbackURL:@"ytplayer://onApiChange?data=" toPlayerView:playerView];
+  [mockDelegate verify];
+}
+
+- (void)testOnAutoplayBlockedCallback {
+  [[mockDelegate expect] playerViewAutoplayWasBlocked:playerView];
+  [self sendCallbackURL:@"ytplayer://onAutoplayBlocked?data=null" toPlayerView:playerView];
+  [mockDelegate verify];
+}
+
+- (void)testBridgeHandlesEveryPlayerCallback {
+  NSDictionary<NSString *, NSString *> *callbacks = [YTPlayerView playerCallbacks];
+  XCTAssertNotNil(callbacks[@"onPlaybackRateChange"]);
+  XCTAssertNotNil(callbacks[@"onApiChange"]);
+  XCTAssertNotNil(callbacks[@"onAutoplayBlocked"]);
+
+  // Both pages resolve the callbacks to the handlers of the bridge script.
+  JSContext *context = [self bridgeContext];
+  context[@"params"] = @{@"events" : callbacks};
+  [context evaluateScript:
+      @"resolvePlayerEvents(params, createPlayerEventHandlers(function() {}, null, null));"];
+  for (NSString *event in callbacks) {
+    NSString *type = [NSString stringWithFormat:@"typeof params.events['%@']", event];
+    XCTAssertEqualObjects([[context evaluateScript:type] toString], @"function", @"%@", event);
+  }
+}
+
+- (void)testBridgeReportsPlaybackRateApiAndAutoplayEvents {
+  JSContext *context = [self bridgeContext];
+  [context evaluateScript:
+      @"var handlers = createPlayerEventHandlers(sendEvent, null, null);"
+       "var target = { getOptions: function() { return ['captions', 'spherical']; } };"
+       "handlers.onPlaybackRateChange({ target: target, data: 1.5 });"
+       "handlers.onApiChange({ target: target, data: null });"
+       "handlers.onApiChange({ target: {}, data: null });"
+       "handlers.onAutoplayBlocked({ target: target, data: null });"];
+  NSArray<NSString *> *sentEvents = [context[@"sentEvents"] toArray];
+  XCTAssertEqualObjects(sentEvents, (@[ @"ytplayer://onPlaybackRateChange?data=1.5",
+                                        @"ytplayer://onApiChange?data=captions%2Cspherical",
+                                        @"ytplayer://onApiChange?data=",
+                                        @"ytplayer://onAutoplayBlocked?data=null" ]));
+
+  // The events the page sends are the ones the view decodes.
+  [mockDelegate setExpectationOrderMatters:YES];
+  [[mockDelegate expect] playerView:playerView didChangeToPlaybackRate:1.5f];
+  [[mockDelegate expect] playerView:playerView
+                didChangeAPIModules:@[ @"captions", @"spherical" ]];
+  [[mockDelegate expect] playerView:playerView didChangeAPIModules:@[]];
+  [[mockDelegate expect] playerViewAutoplayWasBlocked:playerView];
+  for (NSString *event in sentEvents) {
+    [self sendCallbackURL:event toPlayerView:playerView];
+  }
+  [mockDelegate verify];
+}
+
 - (void)testOnErrorCallback {
   NSURL *url = [[NSURL alloc] initWithString:@"ytplayer://onError?data=101"];
   NSURLRequest *request = [[NSURLRequest alloc] initWithURL:url];
@@ -308,6 +2146,117 @@
   [mockDelegate verify];
 }
 
+- (void)testOnPlayTimeCallbackFeedsBufferEstimator {
+  NSURL *url = [[NSURL alloc] initWithString:
+      @"ytplayer://onPlayTime?data=10&loaded=0.25&duration=100&rate=1"];
+  NSURLRequest *request = [[NSURLRequest alloc] initWithURL:url];
+
+  id actionMock = [OCMockObject mockForClass:[WKNavigationAction class]];
+  OCMStub([actionMock request]).andReturn(request);
+
+  [[mockDelegate expect] playerView:[OCMArg any] didPlayTime:10];
+
+  [(id<WKNavigationDelegate>) playerView webView:mockWebView decidePolicyForNavigationAction:actionMock decisionHandler:^(WKNavigationActionPolicy decision) {}];
+
+  [mockDelegate verify];
+  XCTAssertEqualWithAccuracy(playerView.bufferEstimator.bufferedAheadSeconds, 15, 0.001);
+}
+
+- (void)testBufferEstimatorPredictsStallOnce {
+  YTBufferEstimator *estimator = [[YTBufferEstimator alloc] init];
+  // The buffer fills at half the playback speed, starting 10 seconds ahead.
+  int warnings = 0;
+  int firstWarningStep = -1;
+  for (int step = 0; step < 40; step++) {
+    BOOL warned = [estimator addSampleWithCurrentTime:0.5 * step
+                                       loadedFraction:(10 + 0.25 * step) / 100
+                                             duration:100
+                                         playbackRate:1
+                                            timestamp:0.5 * step];
+    if (warned) {
+      warnings++;
+      firstWarningStep = step;
+    }
+  }
+  XCTAssertEqual(warnings, 1);
+  // The stall is predicted once fewer than 2.5 seconds are buffered, i.e. 5 seconds before it.
+  XCTAssertEqual(firstWarningStep, 31);
+  XCTAssertEqualWithAccuracy(estimator.fillRate, 0.5, 0.001);
+  XCTAssertTrue(estimator.stallPredicted);
+
+  // A buffer that outpaces playback never predicts a stall.
+  [estimator reset];
+  for (int step = 0; step < 40; step++) {
+    XCTAssertFalse([estimator addSampleWithCurrentTime:0.5 * step
+                                        loadedFraction:(1 + step) / 100.0
+                                              duration:100
+                                          playbackRate:1
+                                             timestamp:0.5 * step]);
+  }
+  XCTAssertEqual(estimator.secondsUntilStall, INFINITY);
+}
+
+- (void)testBridgeLatencyEstimatorOnSkewedClocks {
+  YTBridgeLatencyEstimator *estimator = [[YTBridgeLatencyEstimator alloc] init];
+  // The page clock runs 1000s ahead of native. Sync round trips take 4ms to 40ms with the
+  // return leg as long as the outbound one, except for one lopsided slow sample.
+  NSTimeInterval skew = 1000;
+  [estimator addSyncSampleWithNativeSendTime:10 pageTime:10.030 + skew nativeReceiveTime:10.040];
+  [estimator addSyncSampleWithNativeSendTime:11 pageTime:11.002 + skew nativeReceiveTime:11.004];
+  [estimator addSyncSampleWithNativeSendTime:12 pageTime:12.001 + skew nativeReceiveTime:12.020];
+  XCTAssertTrue(estimator.hasClockOffset);
+  XCTAssertEqualWithAccuracy(estimator.clockOffset, skew, 1e-9);
+  XCTAssertEqualWithAccuracy(estimator.clockOffsetUncertainty, 0.002, 1e-9);
+
+  // Events 1, 2, 4 and 6 arrive with 5ms latency, then 3 arrives late and 5 never does.
+  for (NSNumber *sequenceNumber in @[ @1, @2, @4, @6 ]) {
+    NSTimeInterval sent = 20 + sequenceNumber.integerValue * 0.1;
+    NSTimeInterval latency =
+        [estimator recordEventWithSequenceNumber:sequenceNumber.integerValue
+                                        pageTime:sent + skew
+                               nativeReceiveTime:sent + 0.005];
+    XCTAssertEqualWithAccuracy(latency, 0.005, 1e-6);
+  }
+  XCTAssertEqual(estimator.lostEventCount, 2u);
+  [estimator recordEventWithSequenceNumber:3 pageTime:20.3 + skew nativeReceiveTime:20.65];
+  XCTAssertEqual(estimator.reorderedEventCount, 1u);
+  XCTAssertEqual(estimator.lostEventCount, 1u);
+  XCTAssertEqual(estimator.receivedEventCount, 5u);
+  XCTAssertEqualWithAccuracy(estimator.maximumLatency, 0.35, 1e-6);
+  XCTAssertEqualWithAccuracy(estimator.minimumLatency, 0.005, 1e-6);
+
+  // Duplicates are ignored.
+  XCTAssertTrue(isnan([estimator recordEventWithSequenceNumber:3
+                                                      pageTime:20.3 + skew
+                                             nativeReceiveTime:20.7]));
+  XCTAssertEqual(estimator.receivedEventCount, 5u);
+}
+
+- (void)testStampedCallbacksFeedBridgeLatencyEstimator {
+  [[mockDelegate stub] playerView:[OCMArg any] didChangeToState:kYTPlayerStatePlaying];
+  NSURL *url = [NSURL URLWithString:@"ytplayer://onStateChange?data=1&seq=2&ts=1500.5"];
+  NSURLRequest *request = [[NSURLRequest alloc] initWithURL:url];
+  id actionMock = [OCMockObject mockForClass:[WKNavigationAction class]];
+  OCMStub([actionMock request]).andReturn(request);
+  [(id<WKNavigationDelegate>) playerView webView:mockWebView decidePolicyForNavigationAction:actionMock decisionHandler:^(WKNavigationActionPolicy decision) {}];
+
+  XCTAssertEqual(playerView.bridgeLatencyEstimator.receivedEventCount, 1u);
+  XCTAssertEqual(playerView.bridgeLatencyEstimator.lostEventCount, 1u);
+}
+
+- (void)testBridgeClockIsSynchronizedOnFirstReadAfterReady {
+  [[mockDelegate stub] playerViewDidBecomeReady:[OCMArg any]];
+  [self sendCallbackURL:@"ytplayer://onReady?data=null&seq=1&ts=1000" toPlayerView:playerView];
+
+  // Only the first read sends a sync request; the strict web view mock rejects any other.
+  [[mockWebView expect] evaluateJavaScript:[OCMArg checkWithBlock:^BOOL(NSString *js) {
+    return [js hasPrefix:@"syncClock("];
+  }] completionHandler:[OCMArg any]];
+  XCTAssertFalse(playerView.bridgeLatencyEstimator.hasClockOffset);
+  XCTAssertEqual(playerView.bridgeLatencyEstimator.receivedEventCount, 1u);
+  [mockWebView verify];
+}
+
 - (void)testGetAvailablePlaybackRates {
   XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
 
@@ -358,6 +2307,297 @@
   [self waitForExpectations:@[expectation] timeout:1.0];
 }
 
+#pragma mark - Time to ready
+
+// Loads players in a real web view against the stand-in iframe API served through
+// YTPlayerView::embedHostURL, and measures the time from the load call to
+// -playerViewDidBecomeReady:, i.e. page parsing, the bridge script, the iframe API callback and
+// the ready event crossing the bridge.
+- (void)testTimeToReadyAgainstLocalStandIn {
+  NSURL *standInURL = [NSURL URLWithString:[kYTStandInScheme stringByAppendingString:@"://api"]];
+  [self measureMetrics:@[ XCTPerformanceMetric_WallClockTime ]
+      automaticallyStartMeasuring:NO
+                         forBlock:^{
+    YTPlayerView *player =
+        [[YTStandInPlayerView alloc] initWithFrame:CGRectMake(0, 0, 320, 180)];
+    player.embedHostURL = standInURL;
+    XCTestExpectation *ready = [self expectationWithDescription:@"ready"];
+    id delegate = OCMProtocolMock(@protocol(YTPlayerViewDelegate));
+    OCMStub([delegate playerViewDidBecomeReady:player]).andDo(^(NSInvocation *invocation) {
+      [ready fulfill];
+    });
+    player.delegate = delegate;
+
+    [self startMeasuring];
+    XCTAssertTrue([player loadWithVideoId:@"M7lc1UVf-VE"]);
+    [self waitForExpectations:@[ ready ] timeout:10];
+    [self stopMeasuring];
+    [player removeWebView];
+  }];
+}
+
+#pragma mark - Hosted players
+
+- (void)postMessage:(NSString *)message toHostView:(YTPlayerHostView *)hostView {
+  id messageMock = OCMClassMock([WKScriptMessage class]);
+  OCMStub([messageMock body]).andReturn(message);
+  [hostView userContentController:OCMClassMock([WKUserContentController class])
+          didReceiveScriptMessage:messageMock];
+}
+
+- (void)testHostedPlayersShareOneWebView {
+  YTPlayerHostView *hostView = [[YTPlayerHostView alloc] initWithFrame:CGRectMake(0, 0, 400, 400)];
+  YTPlayerView *first = [[YTPlayerView alloc] initWithHostView:hostView];
+  YTPlayerView *second = [[YTPlayerView alloc] initWithHostView:hostView];
+  XCTAssertEqual(hostView.playerCount, 2u);
+  XCTAssertNotEqualObjects(first.playerId, second.playerId);
+  XCTAssertNil(first.webView);
+
+  // Commands issued before the iframe API has loaded are queued, then evaluated against the
+  // right player.
+  hostView.webView = mockWebView;
+  [second playVideo];
+  [[mockWebView expect] evaluateJavaScript:[OCMArg checkWithBlock:^BOOL(NSString *js) {
+    NSString *target = [NSString stringWithFormat:@"hostedPlayer('%@')", second.playerId];
+    return [js containsString:@"return player.playVideo();"] && [js containsString:target];
+  }] completionHandler:nil];
+  [self postMessage:@"ytplayer://onHostReady" toHostView:hostView];
+  [mockWebView verify];
+
+  // Events are routed by player ID.
+  id firstDelegate = [OCMockObject mockForProtocol:@protocol(YTPlayerViewDelegate)];
+  id secondDelegate = [OCMockObject mockForProtocol:@protocol(YTPlayerViewDelegate)];
+  first.delegate = firstDelegate;
+  second.delegate = secondDelegate;
+  [[secondDelegate expect] playerView:second didChangeToState:kYTPlayerStatePlaying];
+  NSString *event = [NSString stringWithFormat:
+      @"ytplayer://onStateChange?data=1&player=%@&seq=1&ts=10", second.playerId];
+  [self postMessage:event toHostView:hostView];
+  [secondDelegate verify];
+  [firstDelegate verify];
+  XCTAssertEqual(second.lastReportedState, kYTPlayerStatePlaying);
+  XCTAssertEqual(first.lastReportedState, kYTPlayerStateUnstarted);
+
+  // Releasing a hosted player detaches it from the page.
+  [[mockWebView expect] evaluateJavaScript:[OCMArg checkWithBlock:^BOOL(NSString *js) {
+    return [js hasPrefix:@"removePlayer("];
+  }] completionHandler:nil];
+  first.delegate = nil;
+  first = nil;
+  [mockWebView verify];
+  XCTAssertEqual(hostView.playerCount, 1u);
+}
+
+- (void)testHostViewDropsQueuedCommandsWhenTheIframeAPIFailsToLoad {
+  YTPlayerHostView *hostView = [[YTPlayerHostView alloc] initWithFrame:CGRectMake(0, 0, 400, 400)];
+  YTPlayerView *hosted = [[YTPlayerView alloc] initWithHostView:hostView];
+  hostView.webView = mockWebView;
+  hosted.delegate = mockDelegate;
+  [hosted playVideo];
+
+  [[mockDelegate expect] playerView:hosted
+      didFailToLoadIframeAPIWithError:[OCMArg checkWithBlock:^BOOL(NSError *error) {
+        return error.code == kYTPlayerViewErrorIframeAPIFailedToLoad;
+      }]];
+  [self postMessage:@"ytplayer://onYouTubeIframeAPIFailedToLoad" toHostView:hostView];
+  [mockDelegate verify];
+
+  // The strict web view mock fails if the dropped command is ever evaluated.
+  [hosted pauseVideo];
+  [self postMessage:@"ytplayer://onHostReady" toHostView:hostView];
+  [mockWebView verify];
+
+  [[mockWebView expect] evaluateJavaScript:[OCMArg checkWithBlock:^BOOL(NSString *js) {
+    return [js hasPrefix:@"removePlayer("];
+  }] completionHandler:nil];
+  hosted.delegate = nil;
+  hosted = nil;
+  [mockWebView verify];
+}
+
+- (void)testHostViewRendersItsEmbedHostIntoThePage {
+  YTMockWebViewHostView *hostView =
+      [[YTMockWebViewHostView alloc] initWithFrame:CGRectMake(0, 0, 400, 400)];
+  hostView.embedHostURL = [NSURL URLWithString:@"http://localhost:8080/"];
+  YTPlayerView *hosted = [[YTPlayerView alloc] initWithHostView:hostView];
+  XCTAssertEqualObjects(hosted.embedHostURL, hostView.embedHostURL);
+
+  [hostView createNewWebViewWithConfiguration:[[WKWebViewConfiguration alloc] init]];
+  [[hostView.mockWebView expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+    return [html containsString:@"<link rel=\"preconnect\" href=\"http://localhost:8080\">"] &&
+           [html containsString:@"src=\"http://localhost:8080/iframe_api\""] &&
+           ![html containsString:@"www.youtube.com"] &&
+           [html containsString:[YTPlayerView bridgeScript]];
+  }] baseURL:[OCMArg any]];
+  XCTAssertTrue([hosted loadWithVideoId:@"M7lc1UVf-VE"]);
+  [hostView.mockWebView verify];
+
+  // The embeds of the custom host load in the shared web view.
+  NSURL *embedURL = [NSURL URLWithString:@"http://localhost:8080/embed/M7lc1UVf-VE"];
+  id actionMock = OCMClassMock([WKNavigationAction class]);
+  OCMStub([actionMock request]).andReturn([NSURLRequest requestWithURL:embedURL]);
+  __block WKNavigationActionPolicy policy = WKNavigationActionPolicyCancel;
+  [hostView webView:hostView.mockWebView
+      decidePolicyForNavigationAction:actionMock
+                      decisionHandler:^(WKNavigationActionPolicy decision) {
+                        policy = decision;
+                      }];
+  XCTAssertEqual(policy, WKNavigationActionPolicyAllow);
+}
+
+#pragma mark - Feed scroll workload
+
+// A synthetic scroll trace: the feed has |kFeedCellCount| cells of |kFeedCellHeight| points and
+// the viewport scrolls through them at |kFeedScrollVelocity| points per frame at 60fps.
+static const NSInteger kFeedCellCount = 300;
+static const CGFloat kFeedCellHeight = 240;
+static const CGFloat kFeedViewportHeight = 720;
+static const CGFloat kFeedScrollVelocity = 48;
+
+- (void)testFeedScrollWorkloadPerformance {
+  NSInteger frameCount =
+      (NSInteger)((kFeedCellCount * kFeedCellHeight - kFeedViewportHeight) / kFeedScrollVelocity);
+  NSArray<NSURL *> *cellEvents = @[
+    [NSURL URLWithString:@"ytplayer://onReady?data=null"],
+    [NSURL URLWithString:@"ytplayer://onStateChange?data=3"],
+    [NSURL URLWithString:@"ytplayer://onStateChange?data=1"],
+    [NSURL URLWithString:@"ytplayer://onPlayTime?data=0.5"],
+    [NSURL URLWithString:@"ytplayer://onPlaybackQualityChange?data=medium"]
+  ];
+
+  void (^replayTrace)(void) = ^{
+    NSMutableDictionary<NSNumber *, YTPlayerView *> *liveCells = [NSMutableDictionary dictionary];
+    for (NSInteger frame = 0; frame < frameCount; frame++) {
+      CGFloat offset = frame * kFeedScrollVelocity;
+      NSInteger first = (NSInteger)(offset / kFeedCellHeight);
+      NSInteger last = MIN(kFeedCellCount - 1,
+                           (NSInteger)((offset + kFeedViewportHeight) / kFeedCellHeight));
+
+      // Tear down the cells that scrolled off screen.
+      for (NSNumber *index in liveCells.allKeys) {
+        if (index.integerValue < first || index.integerValue > last) {
+          YTPlayerView *cell = liveCells[index];
+          [cell pauseVideo];
+          [cell removeWebView];
+          [liveCells removeObjectForKey:index];
+        }
+      }
+
+      // Configure and load the cells that scrolled on screen, then replay their bridge traffic.
+      for (NSInteger index = first; index <= last; index++) {
+        if (liveCells[@(index)]) {
+          continue;
+        }
+        YTPlayerView *cell = [[YTFeedCellPlayerView alloc] init];
+        NSString *videoId = [NSString stringWithFormat:@"VIDEO%06ld", (long)index];
+        [cell loadWithVideoId:videoId playerVars:@{ @"playsinline" : @1, @"controls" : @0 }];
+        for (NSURL *event in cellEvents) {
+          NSURLRequest *request = [NSURLRequest requestWithURL:event];
+          id actionMock = OCMClassMock([WKNavigationAction class]);
+          OCMStub([actionMock request]).andReturn(request);
+          [(id<WKNavigationDelegate>)cell webView:cell.webView
+                  decidePolicyForNavigationAction:actionMock
+                                  decisionHandler:^(WKNavigationActionPolicy decision) {}];
+        }
+        [cell seekToSeconds:12.5 allowSeekAhead:YES];
+        liveCells[@(index)] = cell;
+      }
+    }
+    for (YTPlayerView *cell in liveCells.allValues) {
+      [cell removeWebView];
+    }
+  };
+
+  if (@available(iOS 13.0, *)) {
+    XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+    options.iterationCount = 5;
+    [self measureWithMetrics:@[ [[XCTClockMetric alloc] init],
+                                [[XCTCPUMetric alloc] init],
+                                [[XCTMemoryMetric alloc] init] ]
+                     options:options
+                       block:replayTrace];
+  } else {
+    [self measureBlock:replayTrace];
+  }
+}
+
+#pragma mark - Player count scaling
+
+// Dispatches |eventsPerPlayer| bridge events to each of |players| and returns the per-event
+// dispatch latencies in seconds, sorted.
+- (NSArray<NSNumber *> *)dispatchEvents:(NSInteger)eventsPerPlayer
+                              toPlayers:(NSArray<YTPlayerView *> *)players {
+  NSArray<NSURLRequest *> *requests = @[
+    [NSURLRequest requestWithURL:[NSURL URLWithString:
+        @"ytplayer://onPlayTime?data=12.5&loaded=0.5&duration=300&rate=1"]],
+    [NSURLRequest requestWithURL:[NSURL URLWithString:@"ytplayer://onStateChange?data=1"]],
+    [NSURLRequest requestWithURL:[NSURL URLWithString:
+        @"https://www.youtube.com/embed/M7lc1UVf-VE?enablejsapi=1"]]
+  ];
+  NSMutableArray<id> *actions = [NSMutableArray array];
+  for (NSURLRequest *request in requests) {
+    id actionMock = OCMClassMock([WKNavigationAction class]);
+    OCMStub([actionMock request]).andReturn(request);
+    [actions addObject:actionMock];
+  }
+
+  NSMutableArray<NSNumber *> *latencies =
+      [NSMutableArray arrayWithCapacity:players.count * eventsPerPlayer];
+  for (NSInteger i = 0; i < eventsPerPlayer; i++) {
+    id action = actions[i % actions.count];
+    for (YTPlayerView *player in players) {
+      CFTimeInterval start = CACurrentMediaTime();
+      [(id<WKNavigationDelegate>)player webView:player.webView
+                decidePolicyForNavigationAction:action
+                                decisionHandler:^(WKNavigationActionPolicy decision) {}];
+      [latencies addObject:@(CACurrentMediaTime() - start)];
+    }
+  }
+  return [latencies sortedArrayUsingSelector:@selector(compare:)];
+}
+
+// Dispatching an event to one player must not depend on how many other players exist: the median
+// latency with 1000 players stays within 4x of that with 10, plus 10us for timer granularity.
+- (void)testEventDispatchScalesWithPlayerCount {
+  NSMutableDictionary<NSNumber *, NSNumber *> *medianLatencies = [NSMutableDictionary dictionary];
+  for (NSNumber *playerCount in @[ @10, @1000 ]) {
+    NSMutableArray<YTPlayerView *> *players = [NSMutableArray array];
+    for (NSInteger i = 0; i < playerCount.integerValue; i++) {
+      YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+      [player loadWithVideoId:@"M7lc1UVf-VE"];
+      [players addObject:player];
+    }
+    NSArray<NSNumber *> *latencies = [self dispatchEvents:30 toPlayers:players];
+    medianLatencies[playerCount] = latencies[latencies.count / 2];
+    for (YTPlayerView *player in players) {
+      [player removeWebView];
+    }
+  }
+  double smallMedian = medianLatencies[@10].doubleValue;
+  double largeMedian = medianLatencies[@1000].doubleValue;
+  XCTAssertLessThan(largeMedian, 4 * smallMedian + 10e-6,
+                    @"median dispatch latency %.1fus with 10 players, %.1fus with 1000",
+                    smallMedian * 1e6, largeMedian * 1e6);
+}
+
+- (void)testThousandPlayersEventDispatchPerformance {
+  NSMutableArray<YTPlayerView *> *players = [NSMutableArray array];
+  for (NSInteger i = 0; i < 1000; i++) {
+    YTPlayerView *player = [[YTFeedCellPlayerView alloc] init];
+    [player loadWithVideoId:@"M7lc1UVf-VE"];
+    [players addObject:player];
+  }
+  void (^dispatchRound)(void) = ^{
+    [self dispatchEvents:10 toPlayers:players];
+  };
+  if (@available(iOS 13.0, *)) {
+    [self measureWithMetrics:@[ [[XCTCPUMetric alloc] init], [[XCTMemoryMetric alloc] init] ]
+                       block:dispatchRound];
+  } else {
+    [self measureBlock:dispatchRound];
+  }
+}
+
 #pragma mark - Testing catching non-embed URLs
 
 - (void)testCatchingEmbedUrls {
@@ -399,4 +2639,41 @@
   [mockApplication stopMocking];
 }
 
+- (void)testCatchingCustomEmbedHostUrls {
+  playerView.embedHostURL = [NSURL URLWithString:@"http://localhost:8080/"];
+  NSURL *standInEmbed = [NSURL URLWithString:@"http://localhost:8080/embed/M7lc1UVf-VE"];
+  NSURLRequest *request = [[NSURLRequest alloc] initWithURL:standInEmbed];
+
+  id actionMock = [OCMockObject mockForClass:[WKNavigationAction class]];
+  OCMStub([actionMock request]).andReturn(request);
+
+  id mockApplication = [OCMockObject partialMockForObject:[UIApplication sharedApplication]];
+  [[mockApplication reject] openURL:standInEmbed options:[OCMArg any] completionHandler:[OCMArg any]];
+
+  [(id<WKNavigationDelegate>) playerView webView:mockWebView decidePolicyForNavigationAction:actionMock decisionHandler:^(WKNavigationActionPolicy decision) {
+    XCTAssertEqual(WKNavigationActionPolicyAllow, decision, @"WKWebView should navigate to the stand-in embed URL");
+  }];
+
+  [mockApplication verify];
+  [mockApplication stopMocking];
+}
+
+- (void)testLoadPlayerWithCustomEmbedHost {
+  WKWebView *webView = [[WKWebView alloc] init];
+  id partialWebViewMock = [OCMockObject partialMockForObject:webView];
+  id partialPlayer = [self makePartialPlayerMockWithWebView:partialWebViewMock];
+
+  [(WKWebView *)[partialWebViewMock expect] loadHTMLString:[OCMArg checkWithBlock:^BOOL(NSString *html) {
+      return [html rangeOfString:@"src=\"http://localhost:8080/iframe_api\""].location != NSNotFound &&
+             [html rangeOfString:@"\"host\" : \"http:\\/\\/localhost:8080\""].location != NSNotFound;
+  }]
+                                      baseURL:[OCMArg any]];
+  playerView.embedHostURL = [NSURL URLWithString:@"http://localhost:8080/"];
+  [partialPlayer loadWithVideoId:@"VIDEO_ID_HERE"];
+  [partialWebViewMock verify];
+
+  playerView.embedHostURL = nil;
+  XCTAssertEqualObjects(playerView.embedHostURL.absoluteString, @"https://www.youtube.com");
+}
+
 @end
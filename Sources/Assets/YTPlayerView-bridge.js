@@ -0,0 +1,265 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The bridge between the iframe API and YTPlayerView. It is the same for every player, so it is
+// kept out of the page template: YTPlayerView either inlines it into the page or, when serving
+// the page through YTPlayerPageSchemeHandler, references it by a content-hashed URL that WebKit
+// can cache. It expects playerParams and initialState to be defined by the page.
+// YTPlayerHostView inlines it into its page as well, for the player event handlers.
+
+var player;
+
+// Every event sent to native carries a sequence number and the time it was sent on the
+// page's monotonic clock, so native can measure bridge latency and notice reordered or
+// dropped events.
+var eventSequenceNumber = 0;
+
+function sendEvent(action, query) {
+    eventSequenceNumber++;
+    window.location.href = 'ytplayer://' + action + '?' + query +
+        '&seq=' + eventSequenceNumber + '&ts=' + performance.now();
+}
+
+// The YT.Player methods called by dispatchCommands(), indexed by YTPlayerOpcode.
+var commandMethods = [null, 'playVideo', 'pauseVideo', 'stopVideo', 'seekTo', 'cueVideoById',
+    'loadVideoById', 'cueVideoByUrl', 'loadVideoByUrl', 'cuePlaylist', 'loadPlaylist', 'nextVideo',
+    'previousVideo', 'playVideoAt', 'setPlaybackRate', 'setLoop', 'setShuffle',
+    'setSphericalProperties'];
+
+// Runs a batch of commands encoded by YTPlayerCommandEncoder. Each command is an array of an
+// opcode followed by the arguments of the method it calls. Returns nothing: the YT.Player
+// methods return the player itself, which cannot be passed back to native.
+function dispatchCommands(commands) {
+    for (var i = 0; i < commands.length; i++) {
+        var command = commands[i];
+        var method = player && player[commandMethods[command[0]]];
+        if (method) {
+            method.apply(player, command.slice(1));
+        }
+    }
+}
+
+// Called by -synchronizeBridgeClock with the native time it was sent at.
+function syncClock(nativeTime) {
+    sendEvent('onClockSync', 'data=' + nativeTime);
+}
+
+// Called by the iframe API as soon as YT.Player can be constructed. The player is sized by
+// the 100% width and height in its parameters and the page stylesheet, so no layout has
+// to be read before it is created.
+function onYouTubeIframeAPIReady() {
+    if (player) {
+        return;
+    }
+    resolvePlayerEvents(playerParams,
+        createPlayerEventHandlers(sendEvent, initialState, startReporting));
+    player = new YT.Player('player', playerParams);
+    sendEvent('onYouTubeIframeAPIReady', 'data=null');
+}
+
+// this will transmit playTime frequently while playng
+function getCurrentTime() {
+     var state = player.getPlayerState();
+     if (state == YT.PlayerState.PLAYING) {
+         time = player.getCurrentTime()
+         // The buffer state rides along so native can estimate the buffer ahead
+         // without polling.
+         sendEvent('onPlayTime', 'data=' + time +
+             '&loaded=' + player.getVideoLoadedFraction() +
+             '&duration=' + player.getDuration() +
+             '&rate=' + player.getPlaybackRate());
+     }
+}
+
+// Periodic reports only start once the player is ready, so they stay off the startup path.
+function startReporting() {
+    window.setInterval(getCurrentTime, 500);
+
+    // Offset from the play time reports so that both callbacks never navigate in the same tick.
+    window.setTimeout(function() {
+        window.setInterval(reportSphericalProperties, 500);
+    }, 250);
+}
+
+function applyInitialState(target, state) {
+    if (!state) {
+        return;
+    }
+    if (state.playbackRate !== undefined) {
+        target.setPlaybackRate(state.playbackRate);
+    }
+    if (state.loop !== undefined) {
+        target.setLoop(state.loop);
+    }
+    if (state.shuffle !== undefined) {
+        target.setShuffle(state.shuffle);
+    }
+    if (state.playlist !== undefined) {
+        // A restored playlist position: cued, or loaded if it was playing, at the index and time
+        // in one command, so the seek is not lost while the video at the index loads.
+        var startSeconds = state.seekToSeconds || 0;
+        var cue = state.playVideo ? target.loadPlaylist : target.cuePlaylist;
+        if (typeof state.playlist == 'string') {
+            cue.call(target, {list: state.playlist, listType: state.listType,
+                              index: state.playlistIndex, startSeconds: startSeconds});
+        } else {
+            cue.call(target, state.playlist, state.playlistIndex, startSeconds);
+        }
+        return;
+    }
+    if (state.playlistIndex !== undefined) {
+        target.playVideoAt(state.playlistIndex);
+    }
+    if (state.seekToSeconds !== undefined) {
+        target.seekTo(state.seekToSeconds, true);
+    }
+    if (state.playVideo) {
+        target.playVideo();
+    }
+}
+
+// Mirrors the camera orientation of 360° videos to native whenever it changes, so that
+// reading it natively never needs a round trip.
+var lastSphericalProperties = '';
+
+function reportSphericalProperties() {
+    if (!player.getSphericalProperties) {
+        return;
+    }
+    var properties = player.getSphericalProperties();
+    if (!properties || properties.yaw === undefined) {
+        return;
+    }
+    var data = [properties.yaw, properties.pitch, properties.roll, properties.fov].join(',');
+    if (data != lastSphericalProperties) {
+        lastSphericalProperties = data;
+        sendEvent('onSphericalPropertiesChange', 'data=' + data);
+    }
+}
+
+// Returns the handlers of one player for the events named in YTPlayerView::playerCallbacks,
+// keyed by those names. |send| takes an action and a query and sends the event to the native
+// view of that player. |state| is applied to the player before it reports it is ready, and
+// |onReady|, if set, is called then as well.
+function createPlayerEventHandlers(send, state, onReady) {
+    // Set by error 100, whose state change to unstarted is not reported.
+    var error = false;
+    return {
+        onReady: function(event) {
+            applyInitialState(event.target, state);
+            if (onReady) {
+                onReady();
+            }
+            send('onReady', 'data=' + event.data);
+        },
+        onStateChange: function(event) {
+            if (!error) {
+                send('onStateChange', 'data=' + event.data + currentVideoQuery(event.target));
+            } else {
+                error = false;
+            }
+        },
+        onPlaybackQualityChange: function(event) {
+            send('onPlaybackQualityChange', 'data=' + event.data);
+        },
+        onPlayerError: function(event) {
+            if (event.data == 100) {
+                error = true;
+            }
+            send('onError', 'data=' + event.data);
+        },
+        onPlaybackRateChange: function(event) {
+            send('onPlaybackRateChange', 'data=' + event.data);
+        },
+        // The event carries no data; the modules now loaded, e.g. captions, are listed by
+        // getOptions().
+        onApiChange: function(event) {
+            var modules = event.target.getOptions ? event.target.getOptions() : [];
+            send('onApiChange', 'data=' + encodeURIComponent(modules.join(',')));
+        },
+        // Only fired by browsers and API versions that block autoplay; the event carries no data.
+        onAutoplayBlocked: function(event) {
+            send('onAutoplayBlocked', 'data=null');
+        }
+    };
+}
+
+// Returns the video and playlist position |target| is at as query parameters, so that native
+// can restore them after hibernation. The video ID comes from the documented getVideoUrl().
+function currentVideoQuery(target) {
+    var query = '';
+    if (target && target.getVideoUrl) {
+        var match = /[?&]v=([^&#]*)/.exec(target.getVideoUrl() || '');
+        if (match) {
+            query += '&video=' + match[1];
+        }
+    }
+    if (target && target.getPlaylistIndex) {
+        var index = target.getPlaylistIndex();
+        if (typeof index == 'number') {
+            query += '&index=' + index;
+        }
+    }
+    return query;
+}
+
+// Replaces the handler names in the events of |params| with the matching |handlers|.
+function resolvePlayerEvents(params, handlers) {
+    var events = {};
+    for (var event in params.events) {
+        events[event] = handlers[params.events[event]];
+    }
+    params.events = events;
+}
+
+// Resize events can fire many times per frame during rotations and collection view
+// animations. They are coalesced into at most one player.setSize per animation frame, which
+// is skipped when the size has not changed, and held entirely while native defers them.
+var resizeFrameRequested = false;
+var resizesDeferred = false;
+var lastWidth = -1;
+var lastHeight = -1;
+
+function scheduleResize() {
+    if (resizesDeferred || resizeFrameRequested) {
+        return;
+    }
+    resizeFrameRequested = true;
+    window.requestAnimationFrame(applyResize);
+}
+
+function applyResize() {
+    resizeFrameRequested = false;
+    if (!player || !player.setSize) {
+        return;
+    }
+    var width = window.innerWidth;
+    var height = window.innerHeight;
+    if (width == lastWidth && height == lastHeight) {
+        return;
+    }
+    lastWidth = width;
+    lastHeight = height;
+    player.setSize(width, height);
+}
+
+// Called by -setResizesDeferred:.
+function setResizesDeferred(deferred) {
+    resizesDeferred = deferred;
+    if (!deferred) {
+        scheduleResize();
+    }
+}
+
+window.addEventListener('resize', scheduleResize);
@@ -0,0 +1,67 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <UIKit/UIKit.h>
+
+@class YTPlayerView;
+
+/**
+ * YTAutoplaySelector decides which of several YTPlayerView instances in a scrolling feed should
+ * be playing, based on how much of each is visible. Feed visibility fractions for the registered
+ * players on every scroll callback, then call YTAutoplaySelector::updateAtTime:.
+ *
+ * To avoid thrashing between similarly visible cells, a player only takes over from the playing
+ * one when it is visible by at least YTAutoplaySelector::switchMargin more, and only after it has
+ * stayed the best candidate for YTAutoplaySelector::dwellTime. The selector calls
+ * YTPlayerView::playVideo and YTPlayerView::pauseVideo only when the selection changes.
+ *
+ * Players are held weakly. The selector should only be used from the main thread.
+ */
+@interface YTAutoplaySelector : NSObject
+
+/** The minimum visible fraction for a player to be selected. Defaults to 0.5. */
+@property(nonatomic) CGFloat minimumVisibleFraction;
+
+/** How much more visible a player must be to take over from the playing one. Defaults to 0.15. */
+@property(nonatomic) CGFloat switchMargin;
+
+/** How long, in seconds, a player must remain the best candidate to be selected. Defaults to 0.3. */
+@property(nonatomic) CFTimeInterval dwellTime;
+
+/** The player that was last told to play, or nil. */
+@property(nonatomic, weak, readonly, nullable) YTPlayerView *activePlayerView;
+
+/** Adds |playerView| to the players considered for playback, initially not visible. */
+- (void)registerPlayerView:(nonnull YTPlayerView *)playerView;
+
+/** Removes |playerView|. It is paused if it was the active player. */
+- (void)unregisterPlayerView:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Records the fraction of |playerView| currently visible on screen.
+ *
+ * @param fraction A value between 0 (hidden) and 1 (fully visible).
+ * @param playerView A registered player.
+ */
+- (void)setVisibleFraction:(CGFloat)fraction forPlayerView:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Selects the player to play from the recorded visibility and issues the play and pause calls
+ * needed to get there.
+ *
+ * @param time The current time, e.g. from CACurrentMediaTime() or a CADisplayLink timestamp.
+ */
+- (void)updateAtTime:(CFTimeInterval)time;
+
+@end
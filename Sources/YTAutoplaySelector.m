@@ -0,0 +1,156 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTAutoplaySelector.h"
+
+#import "YTPlayerView.h"
+
+/** A registered player and its latest visible fraction. */
+@interface YTAutoplayCandidate : NSObject
+
+@property(nonatomic, weak) YTPlayerView *playerView;
+@property(nonatomic) CGFloat visibleFraction;
+
+@end
+
+@implementation YTAutoplayCandidate
+@end
+
+@interface YTAutoplaySelector ()
+
+@property(nonatomic, weak) YTPlayerView *activePlayerView;
+
+@end
+
+@implementation YTAutoplaySelector {
+  // Candidates in registration order, which is also the tie-breaking order.
+  NSMutableArray<YTAutoplayCandidate *> *_candidates;
+  // The player waiting out the dwell time to become active, and since when.
+  __weak YTPlayerView *_challenger;
+  CFTimeInterval _challengerSince;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _candidates = [[NSMutableArray alloc] init];
+    _minimumVisibleFraction = 0.5;
+    _switchMargin = 0.15;
+    _dwellTime = 0.3;
+  }
+  return self;
+}
+
+- (void)registerPlayerView:(YTPlayerView *)playerView {
+  if ([self candidateForPlayerView:playerView]) {
+    return;
+  }
+  YTAutoplayCandidate *candidate = [[YTAutoplayCandidate alloc] init];
+  candidate.playerView = playerView;
+  [_candidates addObject:candidate];
+}
+
+- (void)unregisterPlayerView:(YTPlayerView *)playerView {
+  YTAutoplayCandidate *candidate = [self candidateForPlayerView:playerView];
+  if (!candidate) {
+    return;
+  }
+  [_candidates removeObject:candidate];
+  if (playerView == self.activePlayerView) {
+    [playerView pauseVideo];
+    self.activePlayerView = nil;
+  }
+  if (playerView == _challenger) {
+    _challenger = nil;
+  }
+}
+
+- (void)setVisibleFraction:(CGFloat)fraction forPlayerView:(YTPlayerView *)playerView {
+  [self candidateForPlayerView:playerView].visibleFraction = fraction;
+}
+
+- (void)updateAtTime:(CFTimeInterval)time {
+  YTPlayerView *active = self.activePlayerView;
+  CGFloat activeFraction = 0;
+  YTPlayerView *best = nil;
+  CGFloat bestFraction = 0;
+  NSMutableIndexSet *releasedCandidates = nil;
+
+  NSUInteger index = 0;
+  for (YTAutoplayCandidate *candidate in _candidates) {
+    YTPlayerView *playerView = candidate.playerView;
+    if (!playerView) {
+      if (!releasedCandidates) {
+        releasedCandidates = [[NSMutableIndexSet alloc] init];
+      }
+      [releasedCandidates addIndex:index++];
+      continue;
+    }
+    index++;
+    if (playerView == active) {
+      activeFraction = candidate.visibleFraction;
+    }
+    if (candidate.visibleFraction >= self.minimumVisibleFraction &&
+        candidate.visibleFraction > bestFraction) {
+      best = playerView;
+      bestFraction = candidate.visibleFraction;
+    }
+  }
+  if (releasedCandidates) {
+    [_candidates removeObjectsAtIndexes:releasedCandidates];
+  }
+
+  // The active player loses its slot as soon as it is no longer visible enough.
+  if (active && activeFraction < self.minimumVisibleFraction) {
+    [active pauseVideo];
+    self.activePlayerView = nil;
+    active = nil;
+  }
+
+  // Otherwise it keeps it unless the best candidate is clearly more visible.
+  YTPlayerView *desired = best;
+  if (active && (bestFraction < activeFraction + self.switchMargin)) {
+    desired = active;
+  }
+  if (!desired || desired == active) {
+    _challenger = nil;
+    return;
+  }
+
+  if (desired != _challenger) {
+    _challenger = desired;
+    _challengerSince = time;
+  }
+  if (time - _challengerSince < self.dwellTime) {
+    return;
+  }
+
+  _challenger = nil;
+  [active pauseVideo];
+  self.activePlayerView = desired;
+  [desired playVideo];
+}
+
+#pragma mark - Private methods
+
+- (YTAutoplayCandidate *)candidateForPlayerView:(YTPlayerView *)playerView {
+  for (YTAutoplayCandidate *candidate in _candidates) {
+    if (candidate.playerView == playerView) {
+      return candidate;
+    }
+  }
+  return nil;
+}
+
+@end
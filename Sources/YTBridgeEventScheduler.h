@@ -0,0 +1,102 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** These enums represent how urgently a bridge event must be handled. */
+typedef NS_ENUM(NSInteger, YTBridgeEventPriority) {
+    kYTBridgeEventPriorityLow,      // May be deferred, and replaced by a later event of its kind.
+    kYTBridgeEventPriorityNormal,   // May be deferred, but is always handled, in order.
+    kYTBridgeEventPriorityCritical  // Always handled right away.
+};
+
+/**
+ * YTBridgeEventScheduler spreads the handling of bridge events over display frames so that a
+ * burst of events, e.g. when the app returns to the foreground, does not hitch scrolling. Within
+ * each frame interval, events are handled right away until YTBridgeEventScheduler::frameBudget is
+ * spent; later ones are queued and handled at the next display frames, at least one per frame.
+ *
+ * Each event comes from a source, e.g. the player that sent it, and one scheduler can serve many
+ * sources: YTBridgeEventScheduler::sharedScheduler holds every player that uses it to a single
+ * budget per frame, however many players there are.
+ *
+ * Queued events are handled in arrival order. A low priority event replaces a queued one from the
+ * same source with the same coalescing key and takes its place at the end of the queue, so only
+ * the latest play time report of a player, for instance, is handled after a burst. A critical
+ * event is never deferred: it is handled right away, after the events queued before it by the
+ * same source, so it never overtakes them. Events of other sources keep their place.
+ *
+ * The scheduler should only be used from the main thread.
+ */
+@interface YTBridgeEventScheduler : NSObject
+
+/** The scheduler shared by all players that use frame-budgeted event handling. */
++ (nonnull YTBridgeEventScheduler *)sharedScheduler;
+
+/** The time source, in seconds. Defaults to CACurrentMediaTime(); replace it to test. */
+@property(nonatomic, copy, nonnull) NSTimeInterval (^clock)(void);
+
+/** The time events of all sources may take per frame interval, in seconds. Defaults to 4 ms. */
+@property(nonatomic) NSTimeInterval frameBudget;
+
+/** The length of a frame interval, in seconds. Defaults to 1/60 s. */
+@property(nonatomic) NSTimeInterval frameInterval;
+
+/**
+ * Whether queued events are handled by a display link the scheduler runs while events are
+ * queued. Defaults to YES; set it to NO to drive the scheduler with
+ * YTBridgeEventScheduler::processPendingEvents instead.
+ */
+@property(nonatomic) BOOL drivenByDisplayLink;
+
+/** The number of queued events. */
+@property(nonatomic, readonly) NSUInteger pendingEventCount;
+
+/** The number of events that were queued instead of being handled right away. */
+@property(nonatomic, readonly) NSUInteger deferredEventCount;
+
+/** The number of queued events replaced by a later event with the same coalescing key. */
+@property(nonatomic, readonly) NSUInteger coalescedEventCount;
+
+/**
+ * Handles an event now if the frame budget allows, or queues it.
+ *
+ * @param source The object the event comes from. It is not retained.
+ * @param priority How urgently the event must be handled.
+ * @param coalescingKey For low priority events, the kind of event that a later one of from the
+ *                      same source may replace this one while queued. Ignored for other
+ *                      priorities.
+ * @param handler The block that handles the event.
+ * @return YES if the event was queued.
+ */
+- (BOOL)scheduleEventFromSource:(nonnull id)source
+                       priority:(YTBridgeEventPriority)priority
+                  coalescingKey:(nullable NSString *)coalescingKey
+                        handler:(nonnull void (^)(void))handler;
+
+/**
+ * Handles queued events, at least one, until the frame budget is spent. Called at every display
+ * frame while events are queued if YTBridgeEventScheduler::drivenByDisplayLink is YES.
+ *
+ * @return YES if events are still queued.
+ */
+- (BOOL)processPendingEvents;
+
+/** Returns the number of queued events from |source|. */
+- (NSUInteger)pendingEventCountFromSource:(nonnull id)source;
+
+/** Drops the queued events from |source|, e.g. when the page that sent them goes away. */
+- (void)removeAllEventsFromSource:(nonnull id)source;
+
+@end
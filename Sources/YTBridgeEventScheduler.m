@@ -0,0 +1,204 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTBridgeEventScheduler.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+/** A queued event, the source it came from and, for low priority events, its coalescing key. */
+@interface YTBridgeQueuedEvent : NSObject
+
+@property(nonatomic, weak) id source;
+@property(nonatomic, copy) NSString *coalescingKey;
+@property(nonatomic, copy) void (^handler)(void);
+
+@end
+
+@implementation YTBridgeQueuedEvent
+@end
+
+@implementation YTBridgeEventScheduler {
+  // Queued events of all sources in arrival order.
+  NSMutableArray<YTBridgeQueuedEvent *> *_queuedEvents;
+  // The start of the current frame interval and the time spent handling events in it.
+  NSTimeInterval _windowStart;
+  NSTimeInterval _spentInWindow;
+  // Runs while events are queued, if the scheduler is driven by a display link.
+  CADisplayLink *_displayLink;
+}
+
++ (YTBridgeEventScheduler *)sharedScheduler {
+  static YTBridgeEventScheduler *sharedScheduler = nil;
+  static dispatch_once_t predicate;
+  dispatch_once(&predicate, ^{
+    sharedScheduler = [[YTBridgeEventScheduler alloc] init];
+  });
+  return sharedScheduler;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _clock = ^NSTimeInterval {
+      return CACurrentMediaTime();
+    };
+    _frameBudget = 0.004;
+    _frameInterval = 1.0 / 60;
+    _drivenByDisplayLink = YES;
+    _queuedEvents = [[NSMutableArray alloc] init];
+    _windowStart = -INFINITY;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [_displayLink invalidate];
+}
+
+- (NSUInteger)pendingEventCount {
+  return _queuedEvents.count;
+}
+
+- (void)setDrivenByDisplayLink:(BOOL)drivenByDisplayLink {
+  _drivenByDisplayLink = drivenByDisplayLink;
+  [self updateDisplayLink];
+}
+
+- (BOOL)scheduleEventFromSource:(id)source
+                       priority:(YTBridgeEventPriority)priority
+                  coalescingKey:(NSString *)coalescingKey
+                        handler:(void (^)(void))handler {
+  NSTimeInterval now = self.clock();
+  if (now - _windowStart >= self.frameInterval) {
+    _windowStart = now;
+    _spentInWindow = 0;
+  }
+  if (priority == kYTBridgeEventPriorityCritical) {
+    // What the source sent before a critical event is handled before it, so that e.g. a queued
+    // state change is not reported after the end of playback. Other sources wait their turn.
+    [self handleQueuedEventsFromSource:source];
+    [self handleEvent:handler];
+    return NO;
+  }
+  if (_queuedEvents.count == 0 && _spentInWindow < self.frameBudget) {
+    [self handleEvent:handler];
+    return NO;
+  }
+
+  _deferredEventCount++;
+  YTBridgeQueuedEvent *queuedEvent = [[YTBridgeQueuedEvent alloc] init];
+  queuedEvent.source = source;
+  queuedEvent.handler = handler;
+  if (priority == kYTBridgeEventPriorityLow && coalescingKey) {
+    queuedEvent.coalescingKey = coalescingKey;
+    NSUInteger index = [_queuedEvents indexOfObjectPassingTest:
+        ^BOOL(YTBridgeQueuedEvent *queued, NSUInteger i, BOOL *stop) {
+          return queued.source == source && [queued.coalescingKey isEqualToString:coalescingKey];
+        }];
+    if (index != NSNotFound) {
+      // The replacement takes the place of the latest arrival.
+      [_queuedEvents removeObjectAtIndex:index];
+      _coalescedEventCount++;
+    }
+  }
+  [_queuedEvents addObject:queuedEvent];
+  [self updateDisplayLink];
+  return YES;
+}
+
+- (BOOL)processPendingEvents {
+  _windowStart = self.clock();
+  _spentInWindow = 0;
+  while (_queuedEvents.count > 0) {
+    YTBridgeQueuedEvent *queuedEvent = _queuedEvents.firstObject;
+    [_queuedEvents removeObjectAtIndex:0];
+    if (!queuedEvent.source) {
+      // The source went away; nobody is left to handle its events.
+      continue;
+    }
+    [self handleEvent:queuedEvent.handler];
+    if (_spentInWindow >= self.frameBudget) {
+      break;
+    }
+  }
+  [self updateDisplayLink];
+  return self.pendingEventCount > 0;
+}
+
+- (NSUInteger)pendingEventCountFromSource:(id)source {
+  return [self indexesOfQueuedEventsFromSource:source].count;
+}
+
+- (void)removeAllEventsFromSource:(id)source {
+  [_queuedEvents removeObjectsAtIndexes:[self indexesOfQueuedEventsFromSource:source]];
+  [self updateDisplayLink];
+}
+
+#pragma mark - Private methods
+
+/**
+ * Private method returning the positions in the queue of the events from |source|.
+ */
+- (NSIndexSet *)indexesOfQueuedEventsFromSource:(id)source {
+  return [_queuedEvents indexesOfObjectsPassingTest:
+      ^BOOL(YTBridgeQueuedEvent *queued, NSUInteger i, BOOL *stop) {
+        return queued.source == source;
+      }];
+}
+
+/**
+ * Private method handling the queued events from |source| in arrival order, regardless of the
+ * frame budget.
+ */
+- (void)handleQueuedEventsFromSource:(id)source {
+  NSIndexSet *indexes = [self indexesOfQueuedEventsFromSource:source];
+  NSArray<YTBridgeQueuedEvent *> *queuedEvents = [_queuedEvents objectsAtIndexes:indexes];
+  [_queuedEvents removeObjectsAtIndexes:indexes];
+  for (YTBridgeQueuedEvent *queuedEvent in queuedEvents) {
+    [self handleEvent:queuedEvent.handler];
+  }
+  [self updateDisplayLink];
+}
+
+/**
+ * Private method handling an event and charging the time it took to the current frame interval.
+ */
+- (void)handleEvent:(void (^)(void))handler {
+  NSTimeInterval start = self.clock();
+  handler();
+  _spentInWindow += self.clock() - start;
+}
+
+/**
+ * Private method running the display link while events are queued and the scheduler is driven by
+ * it, and stopping it otherwise.
+ */
+- (void)updateDisplayLink {
+  BOOL needsDisplayLink = self.drivenByDisplayLink && _queuedEvents.count > 0;
+  if (needsDisplayLink && !_displayLink) {
+    // The display link retains the scheduler until it is invalidated, once the queue is empty.
+    _displayLink = [CADisplayLink displayLinkWithTarget:self
+                                               selector:@selector(displayLinkDidFire:)];
+    [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+  } else if (!needsDisplayLink && _displayLink) {
+    [_displayLink invalidate];
+    _displayLink = nil;
+  }
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+  [self processPendingEvents];
+}
+
+@end
@@ -0,0 +1,87 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ * YTBridgeLatencyEstimator measures how long events from the player page take to reach native
+ * code, and detects events that arrive out of order or not at all.
+ *
+ * The page stamps every event with a sequence number and the time on its own monotonic clock.
+ * That clock has an unknown offset from the native one, which is estimated from clock sync round
+ * trips: native sends its time to the page, the page echoes it back with its own time, and the
+ * round trip with the smallest duration in the last few is taken to be symmetric. The offset is
+ * then known to within half that round trip.
+ *
+ * YTPlayerView feeds its estimator from every stamped event and synchronizes it when it is first
+ * read after the player became ready. All times are in seconds.
+ */
+@interface YTBridgeLatencyEstimator : NSObject
+
+/** Whether at least one clock sync sample has been added. */
+@property(nonatomic, readonly) BOOL hasClockOffset;
+
+/** The page clock minus the native clock, from the best recent sync sample. */
+@property(nonatomic, readonly) NSTimeInterval clockOffset;
+
+/** Half the round trip of the sync sample YTBridgeLatencyEstimator::clockOffset comes from. */
+@property(nonatomic, readonly) NSTimeInterval clockOffsetUncertainty;
+
+/** The one-way latency of the latest event, or NAN before the clock offset is known. */
+@property(nonatomic, readonly) NSTimeInterval lastLatency;
+
+/** The smallest and largest one-way latencies seen, or NAN before any was measured. */
+@property(nonatomic, readonly) NSTimeInterval minimumLatency;
+@property(nonatomic, readonly) NSTimeInterval maximumLatency;
+
+/** The mean one-way latency, or NAN before any was measured. */
+@property(nonatomic, readonly) NSTimeInterval meanLatency;
+
+/** The number of distinct events received. */
+@property(nonatomic, readonly) NSUInteger receivedEventCount;
+
+/** The number of events that arrived after an event the page sent later. */
+@property(nonatomic, readonly) NSUInteger reorderedEventCount;
+
+/** The number of sequence numbers skipped over and not received since. */
+@property(nonatomic, readonly) NSUInteger lostEventCount;
+
+/**
+ * Adds a clock sync round trip.
+ *
+ * @param nativeSendTime The native time the sync request was sent at.
+ * @param pageTime The page time the request was answered at.
+ * @param nativeReceiveTime The native time the answer was received at.
+ */
+- (void)addSyncSampleWithNativeSendTime:(NSTimeInterval)nativeSendTime
+                               pageTime:(NSTimeInterval)pageTime
+                      nativeReceiveTime:(NSTimeInterval)nativeReceiveTime;
+
+/**
+ * Records a stamped event.
+ *
+ * @param sequenceNumber The sequence number the page gave the event, starting at 1.
+ * @param pageTime The page time the event was sent at.
+ * @param nativeReceiveTime The native time the event was received at.
+ * @return The one-way latency of the event, or NAN if the clock offset is not known yet or the
+ *         event is a duplicate.
+ */
+- (NSTimeInterval)recordEventWithSequenceNumber:(NSUInteger)sequenceNumber
+                                       pageTime:(NSTimeInterval)pageTime
+                              nativeReceiveTime:(NSTimeInterval)nativeReceiveTime;
+
+/** Discards all samples and counts, e.g. when a new player page is loaded. */
+- (void)reset;
+
+@end
@@ -0,0 +1,134 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTBridgeLatencyEstimator.h"
+
+// How many of the most recent sync samples the best one is chosen from. Older samples are
+// dropped so that the estimate follows slow drift between the two clocks.
+static const NSUInteger kYTBridgeLatencyEstimatorSyncWindow = 8;
+
+@interface YTBridgeLatencyEstimator ()
+
+@property(nonatomic) BOOL hasClockOffset;
+@property(nonatomic) NSTimeInterval clockOffset;
+@property(nonatomic) NSTimeInterval clockOffsetUncertainty;
+@property(nonatomic) NSTimeInterval lastLatency;
+@property(nonatomic) NSTimeInterval minimumLatency;
+@property(nonatomic) NSTimeInterval maximumLatency;
+@property(nonatomic) NSUInteger receivedEventCount;
+@property(nonatomic) NSUInteger reorderedEventCount;
+
+@end
+
+@implementation YTBridgeLatencyEstimator {
+  // Ring buffer of recent sync samples, as offset and round trip pairs.
+  NSTimeInterval _syncOffsets[kYTBridgeLatencyEstimatorSyncWindow];
+  NSTimeInterval _syncRoundTrips[kYTBridgeLatencyEstimatorSyncWindow];
+  NSUInteger _syncSampleCount;
+  NSTimeInterval _latencySum;
+  NSUInteger _latencyCount;
+  NSUInteger _highestSequenceNumber;
+  // Sequence numbers below _highestSequenceNumber that have not been received.
+  NSMutableIndexSet *_missingSequenceNumbers;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _missingSequenceNumbers = [[NSMutableIndexSet alloc] init];
+    [self reset];
+  }
+  return self;
+}
+
+- (void)addSyncSampleWithNativeSendTime:(NSTimeInterval)nativeSendTime
+                               pageTime:(NSTimeInterval)pageTime
+                      nativeReceiveTime:(NSTimeInterval)nativeReceiveTime {
+  NSTimeInterval roundTrip = nativeReceiveTime - nativeSendTime;
+  if (roundTrip < 0) {
+    return;
+  }
+  // Assuming both legs take equally long, the page answered halfway through the round trip.
+  NSUInteger slot = _syncSampleCount % kYTBridgeLatencyEstimatorSyncWindow;
+  _syncOffsets[slot] = pageTime - (nativeSendTime + roundTrip / 2);
+  _syncRoundTrips[slot] = roundTrip;
+  _syncSampleCount++;
+
+  NSUInteger best = 0;
+  NSUInteger count = MIN(_syncSampleCount, kYTBridgeLatencyEstimatorSyncWindow);
+  for (NSUInteger i = 1; i < count; i++) {
+    if (_syncRoundTrips[i] < _syncRoundTrips[best]) {
+      best = i;
+    }
+  }
+  self.clockOffset = _syncOffsets[best];
+  self.clockOffsetUncertainty = _syncRoundTrips[best] / 2;
+  self.hasClockOffset = YES;
+}
+
+- (NSTimeInterval)recordEventWithSequenceNumber:(NSUInteger)sequenceNumber
+                                       pageTime:(NSTimeInterval)pageTime
+                              nativeReceiveTime:(NSTimeInterval)nativeReceiveTime {
+  if (sequenceNumber > _highestSequenceNumber) {
+    if (sequenceNumber > _highestSequenceNumber + 1) {
+      [_missingSequenceNumbers
+          addIndexesInRange:NSMakeRange(_highestSequenceNumber + 1,
+                                        sequenceNumber - _highestSequenceNumber - 1)];
+    }
+    _highestSequenceNumber = sequenceNumber;
+  } else if ([_missingSequenceNumbers containsIndex:sequenceNumber]) {
+    [_missingSequenceNumbers removeIndex:sequenceNumber];
+    self.reorderedEventCount++;
+  } else {
+    return NAN;
+  }
+  self.receivedEventCount++;
+
+  if (!self.hasClockOffset) {
+    return NAN;
+  }
+  NSTimeInterval latency = nativeReceiveTime - (pageTime - self.clockOffset);
+  self.lastLatency = latency;
+  self.minimumLatency = _latencyCount ? MIN(self.minimumLatency, latency) : latency;
+  self.maximumLatency = _latencyCount ? MAX(self.maximumLatency, latency) : latency;
+  _latencySum += latency;
+  _latencyCount++;
+  return latency;
+}
+
+- (NSTimeInterval)meanLatency {
+  return _latencyCount ? _latencySum / _latencyCount : NAN;
+}
+
+- (NSUInteger)lostEventCount {
+  return _missingSequenceNumbers.count;
+}
+
+- (void)reset {
+  _syncSampleCount = 0;
+  _latencySum = 0;
+  _latencyCount = 0;
+  _highestSequenceNumber = 0;
+  [_missingSequenceNumbers removeAllIndexes];
+  self.hasClockOffset = NO;
+  self.clockOffset = 0;
+  self.clockOffsetUncertainty = 0;
+  self.lastLatency = NAN;
+  self.minimumLatency = NAN;
+  self.maximumLatency = NAN;
+  self.receivedEventCount = 0;
+  self.reorderedEventCount = 0;
+}
+
+@end
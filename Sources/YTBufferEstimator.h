@@ -0,0 +1,72 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ * YTBufferEstimator tracks how much of a video is buffered ahead of the playhead and how fast the
+ * buffer is filling, from samples of the values returned by getCurrentTime(),
+ * getVideoLoadedFraction(), getDuration() and getPlaybackRate(). From those it predicts when
+ * playback will stall.
+ *
+ * YTPlayerView feeds its estimator from samples pushed by the player page while a video is
+ * playing, so no getter round trips are needed.
+ */
+@interface YTBufferEstimator : NSObject
+
+/**
+ * The prediction horizon in seconds: a stall is predicted when the buffer is expected to run
+ * out within this many seconds. Defaults to 5.
+ */
+@property(nonatomic) NSTimeInterval warningThreshold;
+
+/** Seconds of video buffered ahead of the playhead as of the latest sample. */
+@property(nonatomic, readonly) double bufferedAheadSeconds;
+
+/**
+ * Smoothed rate at which the buffer grows, in seconds of video per second of wall time. Playback
+ * stalls when this stays below the playback rate for long enough.
+ */
+@property(nonatomic, readonly) double fillRate;
+
+/**
+ * Wall-clock seconds until the buffer is expected to run out, or INFINITY if the buffer is
+ * keeping up or the whole video is buffered.
+ */
+@property(nonatomic, readonly) NSTimeInterval secondsUntilStall;
+
+/** Whether a stall is expected within YTBufferEstimator::warningThreshold. */
+@property(nonatomic, readonly, getter=isStallPredicted) BOOL stallPredicted;
+
+/**
+ * Adds a sample.
+ *
+ * @param currentTime The playhead position in seconds.
+ * @param loadedFraction The fraction of the video buffered, between 0 and 1.
+ * @param duration The video duration in seconds.
+ * @param playbackRate The playback rate.
+ * @param timestamp The wall-clock time the sample was taken, in seconds.
+ * @return YES if this sample started a stall prediction, i.e. YTBufferEstimator::stallPredicted
+ *         changed from NO to YES.
+ */
+- (BOOL)addSampleWithCurrentTime:(double)currentTime
+                  loadedFraction:(double)loadedFraction
+                        duration:(double)duration
+                    playbackRate:(double)playbackRate
+                       timestamp:(NSTimeInterval)timestamp;
+
+/** Discards all samples, e.g. when a new video is loaded. */
+- (void)reset;
+
+@end
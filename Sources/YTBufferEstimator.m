@@ -0,0 +1,102 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTBufferEstimator.h"
+
+// Weight of the newest fill rate measurement in the exponentially weighted moving average.
+static const double kYTBufferEstimatorSmoothingFactor = 0.3;
+
+// Buffered ends within this many seconds of the duration count as fully buffered.
+static const double kYTBufferEstimatorFullyBufferedTolerance = 0.5;
+
+@interface YTBufferEstimator ()
+
+@property(nonatomic) double bufferedAheadSeconds;
+@property(nonatomic) double fillRate;
+@property(nonatomic) NSTimeInterval secondsUntilStall;
+@property(nonatomic, getter=isStallPredicted) BOOL stallPredicted;
+
+@end
+
+@implementation YTBufferEstimator {
+  BOOL _hasSample;
+  BOOL _hasFillRate;
+  double _lastCurrentTime;
+  double _lastBufferedEnd;
+  NSTimeInterval _lastTimestamp;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _warningThreshold = 5;
+    _secondsUntilStall = INFINITY;
+  }
+  return self;
+}
+
+- (BOOL)addSampleWithCurrentTime:(double)currentTime
+                  loadedFraction:(double)loadedFraction
+                        duration:(double)duration
+                    playbackRate:(double)playbackRate
+                       timestamp:(NSTimeInterval)timestamp {
+  if (duration <= 0) {
+    return NO;
+  }
+  double bufferedEnd = MIN(MAX(loadedFraction, 0), 1) * duration;
+  self.bufferedAheadSeconds = MAX(bufferedEnd - currentTime, 0);
+
+  if (_hasSample) {
+    NSTimeInterval elapsed = timestamp - _lastTimestamp;
+    BOOL seeked = currentTime < _lastCurrentTime || bufferedEnd < _lastBufferedEnd;
+    if (seeked) {
+      // A seek invalidates the buffer history; start measuring the fill rate again.
+      _hasFillRate = NO;
+    } else if (elapsed > 0) {
+      double rate = (bufferedEnd - _lastBufferedEnd) / elapsed;
+      self.fillRate = _hasFillRate
+          ? kYTBufferEstimatorSmoothingFactor * rate +
+                (1 - kYTBufferEstimatorSmoothingFactor) * self.fillRate
+          : rate;
+      _hasFillRate = YES;
+    }
+  }
+  _hasSample = YES;
+  _lastCurrentTime = currentTime;
+  _lastBufferedEnd = bufferedEnd;
+  _lastTimestamp = timestamp;
+
+  double drainRate = MAX(playbackRate, 0) - self.fillRate;
+  if (!_hasFillRate || bufferedEnd >= duration - kYTBufferEstimatorFullyBufferedTolerance ||
+      drainRate <= 0) {
+    self.secondsUntilStall = INFINITY;
+  } else {
+    self.secondsUntilStall = self.bufferedAheadSeconds / drainRate;
+  }
+
+  BOOL wasStallPredicted = self.stallPredicted;
+  self.stallPredicted = self.secondsUntilStall < self.warningThreshold;
+  return self.stallPredicted && !wasStallPredicted;
+}
+
+- (void)reset {
+  _hasSample = NO;
+  _hasFillRate = NO;
+  self.bufferedAheadSeconds = 0;
+  self.fillRate = 0;
+  self.secondsUntilStall = INFINITY;
+  self.stallPredicted = NO;
+}
+
+@end
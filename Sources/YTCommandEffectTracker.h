@@ -0,0 +1,125 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** These enums represent the player commands whose effect can be tracked. */
+typedef NS_ENUM(NSInteger, YTTrackedCommand) {
+    kYTTrackedCommandPlay,   // Takes effect when the player reports it is playing.
+    kYTTrackedCommandPause,  // Takes effect when the player reports it is paused.
+    kYTTrackedCommandSeek,   // Takes effect when the player reports a time near the target.
+    kYTTrackedCommandCue,    // Takes effect when the player reports the new video is cued.
+    kYTTrackedCommandCount
+};
+
+/** These enums represent how a tracked command ended. */
+typedef NS_ENUM(NSInteger, YTCommandEffectResult) {
+    kYTCommandEffectObserved,    // The player reported the effect of the command.
+    kYTCommandEffectTimedOut,    // The player reported nothing matching in time.
+    kYTCommandEffectSuperseded,  // A later command made the effect moot, e.g. play after pause.
+    kYTCommandEffectCancelled    // The player went away, e.g. because a new one was loaded.
+};
+
+/** The effect latencies of one kind of command, see YTCommandEffectTracker. */
+typedef struct {
+    NSUInteger observedCount;     // Commands whose effect was observed.
+    NSUInteger timedOutCount;     // Commands that timed out.
+    NSUInteger abandonedCount;    // Commands superseded or cancelled.
+    NSTimeInterval meanLatency;   // Of the observed commands, or NAN before any.
+    NSTimeInterval maxLatency;    // Of the observed commands, or 0 before any.
+} YTCommandEffectStatistics;
+
+/**
+ * The block called once a tracked command ends.
+ *
+ * @param result How the command ended.
+ * @param latency The time from sending the command to the end, in seconds.
+ */
+typedef void (^YTCommandEffectHandler)(YTCommandEffectResult result, NSTimeInterval latency);
+
+/**
+ * YTCommandEffectTracker matches player commands, which the IFrame API carries out
+ * asynchronously and without acknowledgement, against the state changes and play time reports
+ * the player sends back, so that their senders learn when the commands took effect.
+ *
+ * A play or pause command that finds the player already in the state it asks for takes effect
+ * right away. Play and pause supersede each other, a seek supersedes an earlier seek, and a cue
+ * supersedes every pending command since it replaces the video. Commands not observed within
+ * YTCommandEffectTracker::timeout end when YTCommandEffectTracker::expireCommandsAtTime: is
+ * next called past their deadline.
+ *
+ * The tracker only depends on Foundation; states are the values of YTPlayerState and times are
+ * in seconds on a monotonic clock such as CACurrentMediaTime(). Handlers are called after the
+ * tracker has been updated, so they may send further commands. The tracker should only be used
+ * from the main thread.
+ */
+@interface YTCommandEffectTracker : NSObject
+
+/** How long a command may take to show its effect, in seconds. Defaults to 5. */
+@property(nonatomic) NSTimeInterval timeout;
+
+/** How far a reported time may be from a seek target, in seconds. Defaults to 1. */
+@property(nonatomic) double seekTolerance;
+
+/** The number of commands whose effect has not been observed yet. */
+@property(nonatomic, readonly) NSUInteger pendingCommandCount;
+
+/**
+ * Starts tracking a play, pause or cue command.
+ *
+ * @param command The command, which must not be kYTTrackedCommandSeek.
+ * @param state The YTPlayerState the player reports once the command took effect.
+ * @param time When the command was sent.
+ * @param handler Called once the command ends, or nil.
+ */
+- (void)trackCommand:(YTTrackedCommand)command
+      expectingState:(NSInteger)state
+              atTime:(NSTimeInterval)time
+             handler:(nullable YTCommandEffectHandler)handler;
+
+/**
+ * Starts tracking a seek command.
+ *
+ * @param seconds The time the player was asked to seek to.
+ * @param time When the command was sent.
+ * @param handler Called once the command ends, or nil.
+ */
+- (void)trackSeekToSeconds:(double)seconds
+                    atTime:(NSTimeInterval)time
+                   handler:(nullable YTCommandEffectHandler)handler;
+
+/** Records a state change reported by the player at |time|. */
+- (void)observeState:(NSInteger)state atTime:(NSTimeInterval)time;
+
+/** Records a play time reported by the player at |time|. */
+- (void)observePlayTime:(double)seconds atTime:(NSTimeInterval)time;
+
+/** Ends the commands whose deadline is before |time| as timed out. */
+- (void)expireCommandsAtTime:(NSTimeInterval)time;
+
+/**
+ * Ends all pending commands as cancelled and forgets the reported state, e.g. when the player
+ * is replaced. The statistics are kept.
+ *
+ * @param time The current time.
+ */
+- (void)cancelAllCommandsAtTime:(NSTimeInterval)time;
+
+/** Returns the effect latencies of |command| since the tracker was created or last reset. */
+- (YTCommandEffectStatistics)statisticsForCommand:(YTTrackedCommand)command;
+
+/** Forgets the statistics of all commands. */
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,209 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTCommandEffectTracker.h"
+
+/** A command waiting for its effect to be reported. */
+@interface YTPendingCommand : NSObject
+
+@property(nonatomic) YTTrackedCommand command;
+// The state a play, pause or cue command waits for, or the target of a seek.
+@property(nonatomic) NSInteger expectedState;
+@property(nonatomic) double targetSeconds;
+@property(nonatomic) NSTimeInterval sentTime;
+@property(nonatomic, copy) YTCommandEffectHandler handler;
+
+@end
+
+@implementation YTPendingCommand
+@end
+
+@implementation YTCommandEffectTracker {
+  // Pending commands in the order they were sent.
+  NSMutableArray<YTPendingCommand *> *_pendingCommands;
+  // The latest state reported by the player, if any since the last cancellation.
+  NSInteger _reportedState;
+  BOOL _hasReportedState;
+  YTCommandEffectStatistics _statistics[kYTTrackedCommandCount];
+  NSTimeInterval _latencySums[kYTTrackedCommandCount];
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _pendingCommands = [[NSMutableArray alloc] init];
+    _timeout = 5;
+    _seekTolerance = 1;
+    [self resetStatistics];
+  }
+  return self;
+}
+
+- (NSUInteger)pendingCommandCount {
+  return _pendingCommands.count;
+}
+
+- (void)trackCommand:(YTTrackedCommand)command
+      expectingState:(NSInteger)state
+              atTime:(NSTimeInterval)time
+             handler:(YTCommandEffectHandler)handler {
+  NSParameterAssert(command != kYTTrackedCommandSeek);
+  BOOL isPlayOrPause = command == kYTTrackedCommandPlay || command == kYTTrackedCommandPause;
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectSuperseded
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                if (command == kYTTrackedCommandCue) {
+                  return YES;
+                }
+                return isPlayOrPause && (pending.command == kYTTrackedCommandPlay ||
+                                         pending.command == kYTTrackedCommandPause);
+              }];
+
+  YTPendingCommand *pending = [[YTPendingCommand alloc] init];
+  pending.command = command;
+  pending.expectedState = state;
+  pending.sentTime = time;
+  pending.handler = handler;
+  // Cueing always produces a new state change, but playing a playing video does not.
+  if (isPlayOrPause && _hasReportedState && _reportedState == state) {
+    [self endCommands:@[ pending ] atTime:time result:kYTCommandEffectObserved];
+    return;
+  }
+  [_pendingCommands addObject:pending];
+}
+
+- (void)trackSeekToSeconds:(double)seconds
+                    atTime:(NSTimeInterval)time
+                   handler:(YTCommandEffectHandler)handler {
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectSuperseded
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                return pending.command == kYTTrackedCommandSeek;
+              }];
+
+  YTPendingCommand *pending = [[YTPendingCommand alloc] init];
+  pending.command = kYTTrackedCommandSeek;
+  pending.targetSeconds = seconds;
+  pending.sentTime = time;
+  pending.handler = handler;
+  [_pendingCommands addObject:pending];
+}
+
+- (void)observeState:(NSInteger)state atTime:(NSTimeInterval)time {
+  _reportedState = state;
+  _hasReportedState = YES;
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectObserved
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                return pending.command != kYTTrackedCommandSeek && pending.expectedState == state;
+              }];
+}
+
+- (void)observePlayTime:(double)seconds atTime:(NSTimeInterval)time {
+  double tolerance = self.seekTolerance;
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectObserved
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                return pending.command == kYTTrackedCommandSeek &&
+                       fabs(pending.targetSeconds - seconds) <= tolerance;
+              }];
+}
+
+- (void)expireCommandsAtTime:(NSTimeInterval)time {
+  NSTimeInterval timeout = self.timeout;
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectTimedOut
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                return time - pending.sentTime >= timeout;
+              }];
+}
+
+- (void)cancelAllCommandsAtTime:(NSTimeInterval)time {
+  _hasReportedState = NO;
+  [self endCommandsAtTime:time
+                   result:kYTCommandEffectCancelled
+              passingTest:^BOOL(YTPendingCommand *pending) {
+                return YES;
+              }];
+}
+
+- (YTCommandEffectStatistics)statisticsForCommand:(YTTrackedCommand)command {
+  NSParameterAssert(command >= 0 && command < kYTTrackedCommandCount);
+  YTCommandEffectStatistics statistics = _statistics[command];
+  statistics.meanLatency = statistics.observedCount > 0
+                               ? _latencySums[command] / statistics.observedCount
+                               : NAN;
+  return statistics;
+}
+
+- (void)resetStatistics {
+  for (NSInteger command = 0; command < kYTTrackedCommandCount; command++) {
+    _statistics[command] = (YTCommandEffectStatistics){0, 0, 0, NAN, 0};
+    _latencySums[command] = 0;
+  }
+}
+
+#pragma mark - Private methods
+
+/**
+ * Ends the pending commands for which |test| returns YES with |result|.
+ */
+- (void)endCommandsAtTime:(NSTimeInterval)time
+                   result:(YTCommandEffectResult)result
+              passingTest:(BOOL (NS_NOESCAPE ^)(YTPendingCommand *pending))test {
+  NSIndexSet *indexes = [_pendingCommands indexesOfObjectsPassingTest:
+      ^BOOL(YTPendingCommand *pending, NSUInteger index, BOOL *stop) {
+        return test(pending);
+      }];
+  if (indexes.count == 0) {
+    return;
+  }
+  NSArray<YTPendingCommand *> *ended = [_pendingCommands objectsAtIndexes:indexes];
+  [_pendingCommands removeObjectsAtIndexes:indexes];
+  [self endCommands:ended atTime:time result:result];
+}
+
+/**
+ * Records |commands|, which are no longer pending, as ended with |result| and calls their
+ * handlers.
+ */
+- (void)endCommands:(NSArray<YTPendingCommand *> *)commands
+             atTime:(NSTimeInterval)time
+             result:(YTCommandEffectResult)result {
+  for (YTPendingCommand *pending in commands) {
+    NSTimeInterval latency = MAX(time - pending.sentTime, 0);
+    YTCommandEffectStatistics *statistics = &_statistics[pending.command];
+    switch (result) {
+      case kYTCommandEffectObserved:
+        statistics->observedCount++;
+        statistics->maxLatency = MAX(statistics->maxLatency, latency);
+        _latencySums[pending.command] += latency;
+        break;
+      case kYTCommandEffectTimedOut:
+        statistics->timedOutCount++;
+        break;
+      case kYTCommandEffectSuperseded:
+      case kYTCommandEffectCancelled:
+        statistics->abandonedCount++;
+        break;
+    }
+  }
+  for (YTPendingCommand *pending in commands) {
+    if (pending.handler) {
+      pending.handler(result, MAX(time - pending.sentTime, 0));
+    }
+  }
+}
+
+@end
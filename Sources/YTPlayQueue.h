@@ -0,0 +1,129 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+@class YTPlayQueue;
+
+/**
+ * A single entry of a YTPlayQueue. Items are handles into the queue: they are passed back to the
+ * queue to insert relative to, move or remove them, which is what keeps those operations O(1).
+ * An item belongs to at most one queue at a time.
+ */
+@interface YTPlayQueueItem : NSObject
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates an item that plays the whole video.
+ *
+ * @param videoId The YouTube video ID to play.
+ */
+- (nonnull instancetype)initWithVideoId:(nonnull NSString *)videoId;
+
+/**
+ * Creates an item that plays part of a video.
+ *
+ * @param videoId The YouTube video ID to play.
+ * @param startSeconds Time in seconds to start the video at.
+ * @param endSeconds Time in seconds to end the video at, or 0 to play until the end.
+ */
+- (nonnull instancetype)initWithVideoId:(nonnull NSString *)videoId
+                           startSeconds:(float)startSeconds
+                             endSeconds:(float)endSeconds NS_DESIGNATED_INITIALIZER;
+
+@property(nonatomic, readonly, nonnull) NSString *videoId;
+@property(nonatomic, readonly) float startSeconds;
+@property(nonatomic, readonly) float endSeconds;
+
+/** The queue this item currently belongs to, or nil. */
+@property(nonatomic, weak, readonly, nullable) YTPlayQueue *queue;
+
+/** The item after this one in its queue, or nil. */
+@property(nonatomic, readonly, nullable) YTPlayQueueItem *nextItem;
+
+/** The item before this one in its queue, or nil. */
+@property(nonatomic, weak, readonly, nullable) YTPlayQueueItem *previousItem;
+
+@end
+
+/**
+ * YTPlayQueue is a mutable, ordered list of videos played one after the other by a YTPlayerView.
+ * Unlike playlists passed to YTPlayerView::loadPlaylistByVideos:index:startSeconds:, the queue
+ * lives natively and can be edited while a video is playing without reloading or rebuffering it:
+ * the player only ever loads one video at a time, and asks the queue for the next item when the
+ * current one ends.
+ *
+ * Appending, inserting, removing and moving items are all O(1). The queue is not thread safe and
+ * should only be used from the main thread.
+ */
+@interface YTPlayQueue : NSObject
+
+/** The number of items in the queue. */
+@property(nonatomic, readonly) NSUInteger count;
+
+@property(nonatomic, readonly, nullable) YTPlayQueueItem *firstItem;
+@property(nonatomic, weak, readonly, nullable) YTPlayQueueItem *lastItem;
+
+/** The item that is playing, or nil if playback has not started or the item was removed. */
+@property(nonatomic, readonly, nullable) YTPlayQueueItem *currentItem;
+
+/**
+ * The item that YTPlayQueue::advance will make current: the item after YTPlayQueue::currentItem,
+ * or, if the current item was removed, the item that followed it.
+ */
+@property(nonatomic, readonly, nullable) YTPlayQueueItem *upNextItem;
+
+/** Adds |item| at the end of the queue. */
+- (void)appendItem:(nonnull YTPlayQueueItem *)item;
+
+/** Adds |item| directly after |existingItem|, which must belong to this queue. */
+- (void)insertItem:(nonnull YTPlayQueueItem *)item afterItem:(nonnull YTPlayQueueItem *)existingItem;
+
+/** Adds |item| directly before |existingItem|, which must belong to this queue. */
+- (void)insertItem:(nonnull YTPlayQueueItem *)item
+        beforeItem:(nonnull YTPlayQueueItem *)existingItem;
+
+/**
+ * Removes |item| from the queue. Removing the current item does not stop playback; the item
+ * that followed it becomes YTPlayQueue::upNextItem.
+ */
+- (void)removeItem:(nonnull YTPlayQueueItem *)item;
+
+/**
+ * Moves |item| directly after |existingItem|, or to the front of the queue if |existingItem| is
+ * nil. Both must belong to this queue.
+ */
+- (void)moveItem:(nonnull YTPlayQueueItem *)item afterItem:(nullable YTPlayQueueItem *)existingItem;
+
+/** Removes all items. */
+- (void)removeAllItems;
+
+/** Makes |item|, which must belong to this queue, the current item. */
+- (void)setCurrentItem:(nonnull YTPlayQueueItem *)item;
+
+/**
+ * Makes YTPlayQueue::upNextItem the current item.
+ *
+ * @return The new current item, or nil when the end of the queue has been reached.
+ */
+- (nullable YTPlayQueueItem *)advance;
+
+/** Returns whether an item of the queue plays |videoId|. */
+- (BOOL)containsVideoId:(nonnull NSString *)videoId;
+
+/** Returns the items in order. This is O(n) and intended for display purposes. */
+- (nonnull NSArray<YTPlayQueueItem *> *)allItems;
+
+@end
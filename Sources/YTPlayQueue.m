@@ -0,0 +1,238 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayQueue.h"
+
+#import "YTVideoId.h"
+
+@interface YTPlayQueueItem ()
+
+// Items form a doubly linked list. Forward links are strong and own the items; backward links
+// are weak so the list has no retain cycles.
+@property(nonatomic, weak) YTPlayQueue *queue;
+@property(nonatomic) YTPlayQueueItem *nextItem;
+@property(nonatomic, weak) YTPlayQueueItem *previousItem;
+
+// The video ID packed if it is well-formed, otherwise the string; used as the item's key in the
+// queue's index of video IDs.
+@property(nonatomic, readonly) id<NSCopying> videoIdKey;
+
+@end
+
+@implementation YTPlayQueueItem {
+  // The video ID is kept packed when it is well-formed, and as given otherwise.
+  YTVideoId *_packedVideoId;
+  NSString *_unpackedVideoId;
+}
+
+- (instancetype)initWithVideoId:(NSString *)videoId {
+  return [self initWithVideoId:videoId startSeconds:0 endSeconds:0];
+}
+
+- (instancetype)initWithVideoId:(NSString *)videoId
+                   startSeconds:(float)startSeconds
+                     endSeconds:(float)endSeconds {
+  self = [super init];
+  if (self) {
+    _packedVideoId = [YTVideoId videoIdWithString:videoId];
+    if (!_packedVideoId) {
+      _unpackedVideoId = [videoId copy];
+    }
+    _startSeconds = startSeconds;
+    _endSeconds = endSeconds;
+  }
+  return self;
+}
+
+- (NSString *)videoId {
+  return _packedVideoId ? _packedVideoId.stringValue : _unpackedVideoId;
+}
+
+- (id<NSCopying>)videoIdKey {
+  return _packedVideoId ?: _unpackedVideoId;
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"<%@: %p; videoId = %@>",
+                                    NSStringFromClass([self class]), self, self.videoId];
+}
+
+@end
+
+@interface YTPlayQueue ()
+
+@property(nonatomic) NSUInteger count;
+@property(nonatomic) YTPlayQueueItem *firstItem;
+@property(nonatomic, weak) YTPlayQueueItem *lastItem;
+
+@end
+
+@implementation YTPlayQueue {
+  // The item that followed the current item when the current item was removed.
+  YTPlayQueueItem *_detachedUpNextItem;
+  // The video IDs of the items, see YTPlayQueueItem::videoIdKey.
+  NSCountedSet *_videoIdKeys;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _videoIdKeys = [[NSCountedSet alloc] init];
+  }
+  return self;
+}
+
+- (YTPlayQueueItem *)upNextItem {
+  if (self.currentItem) {
+    return self.currentItem.nextItem;
+  }
+  return _detachedUpNextItem;
+}
+
+- (void)appendItem:(YTPlayQueueItem *)item {
+  [self linkItem:item afterItem:self.lastItem];
+}
+
+- (void)insertItem:(YTPlayQueueItem *)item afterItem:(YTPlayQueueItem *)existingItem {
+  NSParameterAssert(existingItem.queue == self);
+  [self linkItem:item afterItem:existingItem];
+}
+
+- (void)insertItem:(YTPlayQueueItem *)item beforeItem:(YTPlayQueueItem *)existingItem {
+  NSParameterAssert(existingItem.queue == self);
+  [self linkItem:item afterItem:existingItem.previousItem];
+}
+
+- (void)removeItem:(YTPlayQueueItem *)item {
+  NSParameterAssert(item.queue == self);
+  if (item == self.currentItem) {
+    _detachedUpNextItem = item.nextItem;
+    _currentItem = nil;
+  } else if (item == _detachedUpNextItem) {
+    _detachedUpNextItem = item.nextItem;
+  }
+  [self unlinkItem:item];
+}
+
+- (void)moveItem:(YTPlayQueueItem *)item afterItem:(YTPlayQueueItem *)existingItem {
+  NSParameterAssert(item.queue == self);
+  NSParameterAssert(!existingItem || existingItem.queue == self);
+  if (item == existingItem || item.previousItem == existingItem) {
+    return;
+  }
+  if (item == _detachedUpNextItem) {
+    _detachedUpNextItem = item.nextItem;
+  }
+  [self unlinkItem:item];
+  [self linkItem:item afterItem:existingItem];
+}
+
+- (void)removeAllItems {
+  // Unlink iteratively; releasing a long chain of strong forward links recursively could
+  // otherwise exhaust the stack.
+  YTPlayQueueItem *item = self.firstItem;
+  while (item) {
+    YTPlayQueueItem *next = item.nextItem;
+    item.queue = nil;
+    item.previousItem = nil;
+    item.nextItem = nil;
+    item = next;
+  }
+  self.firstItem = nil;
+  self.lastItem = nil;
+  _currentItem = nil;
+  _detachedUpNextItem = nil;
+  [_videoIdKeys removeAllObjects];
+  self.count = 0;
+}
+
+- (void)setCurrentItem:(YTPlayQueueItem *)item {
+  NSParameterAssert(item.queue == self);
+  _currentItem = item;
+  _detachedUpNextItem = nil;
+}
+
+- (YTPlayQueueItem *)advance {
+  YTPlayQueueItem *next = self.upNextItem;
+  _currentItem = next;
+  _detachedUpNextItem = nil;
+  return next;
+}
+
+- (BOOL)containsVideoId:(NSString *)videoId {
+  id key = [YTVideoId videoIdWithString:videoId] ?: videoId;
+  return [_videoIdKeys containsObject:key];
+}
+
+- (NSArray<YTPlayQueueItem *> *)allItems {
+  NSMutableArray<YTPlayQueueItem *> *items = [[NSMutableArray alloc] initWithCapacity:self.count];
+  for (YTPlayQueueItem *item = self.firstItem; item; item = item.nextItem) {
+    [items addObject:item];
+  }
+  return items;
+}
+
+- (void)dealloc {
+  [self removeAllItems];
+}
+
+#pragma mark - Private methods
+
+/**
+ * Links |item| into the list after |previousItem|, or at the front if |previousItem| is nil.
+ */
+- (void)linkItem:(YTPlayQueueItem *)item afterItem:(YTPlayQueueItem *)previousItem {
+  NSParameterAssert(!item.queue);
+  YTPlayQueueItem *nextItem = previousItem ? previousItem.nextItem : self.firstItem;
+  item.queue = self;
+  item.previousItem = previousItem;
+  item.nextItem = nextItem;
+  if (previousItem) {
+    previousItem.nextItem = item;
+  } else {
+    self.firstItem = item;
+  }
+  if (nextItem) {
+    nextItem.previousItem = item;
+  } else {
+    self.lastItem = item;
+  }
+  [_videoIdKeys addObject:item.videoIdKey];
+  self.count++;
+}
+
+/**
+ * Unlinks |item| from the list, leaving the current item untouched.
+ */
+- (void)unlinkItem:(YTPlayQueueItem *)item {
+  YTPlayQueueItem *previousItem = item.previousItem;
+  YTPlayQueueItem *nextItem = item.nextItem;
+  if (previousItem) {
+    previousItem.nextItem = nextItem;
+  } else {
+    self.firstItem = nextItem;
+  }
+  if (nextItem) {
+    nextItem.previousItem = previousItem;
+  } else {
+    self.lastItem = previousItem;
+  }
+  item.queue = nil;
+  item.previousItem = nil;
+  item.nextItem = nil;
+  [_videoIdKeys removeObject:item.videoIdKey];
+  self.count--;
+}
+
+@end
@@ -0,0 +1,142 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <UIKit/UIKit.h>
+
+@class YTPlayerBudgetManager;
+@class YTPlayerView;
+
+/** What YTPlayerBudgetManager does with a player it evicts. */
+typedef NS_ENUM(NSInteger, YTPlayerEvictionAction) {
+  /** The player is hibernated with YTPlayerView::hibernate and can be restored. */
+  kYTPlayerEvictionActionHibernate,
+  /** The player's web view is removed and the player is unregistered from the manager. */
+  kYTPlayerEvictionActionDestroy
+};
+
+/**
+ * A protocol for observing and steering evictions made by YTPlayerBudgetManager.
+ */
+@protocol YTPlayerBudgetManagerDelegate<NSObject>
+
+@optional
+/**
+ * Asks how to evict |playerView|. Players are hibernated if this is not implemented. Players
+ * that cannot be hibernated, e.g. because nothing was loaded into their web view, are destroyed.
+ *
+ * @param budgetManager The manager evicting the player.
+ * @param playerView The player about to be evicted.
+ * @return The action to take.
+ */
+- (YTPlayerEvictionAction)budgetManager:(nonnull YTPlayerBudgetManager *)budgetManager
+                 actionForEvictingPlayerView:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Invoked after |playerView| has been evicted.
+ *
+ * @param budgetManager The manager that evicted the player.
+ * @param playerView The evicted player.
+ * @param action The action that was taken, which is kYTPlayerEvictionActionDestroy if
+ *               hibernating the player failed.
+ */
+- (void)budgetManager:(nonnull YTPlayerBudgetManager *)budgetManager
+    didEvictPlayerView:(nonnull YTPlayerView *)playerView
+            withAction:(YTPlayerEvictionAction)action;
+
+@end
+
+/**
+ * YTPlayerBudgetManager keeps the estimated memory cost of a set of YTPlayerView instances
+ * within a budget. Each player with a live web view costs YTPlayerBudgetManager::webViewCost,
+ * plus YTPlayerBudgetManager::playingCost while it is playing or buffering and
+ * YTPlayerBudgetManager::visibleCost while it is on screen. Hibernated players cost nothing.
+ *
+ * When YTPlayerBudgetManager::enforceBudget finds the total over budget, it evicts the players
+ * that are cheapest to restore first: off-screen before visible, paused before playing, and least
+ * recently used first among equals. On a memory warning, every player except those both visible
+ * and playing is evicted regardless of the budget.
+ *
+ * Players are held weakly. The manager should only be used from the main thread.
+ */
+@interface YTPlayerBudgetManager : NSObject
+
+/** The total cost the registered players may reach. Defaults to 3. */
+@property(nonatomic) double budget;
+
+/** The cost of a player with a live web view. Defaults to 1. */
+@property(nonatomic) double webViewCost;
+
+/** The additional cost of a player that is playing or buffering. Defaults to 1. */
+@property(nonatomic) double playingCost;
+
+/** The additional cost of a player that is on screen. Defaults to 0.25. */
+@property(nonatomic) double visibleCost;
+
+/** The estimated cost of all registered players. */
+@property(nonatomic, readonly) double totalCost;
+
+/** A delegate to be notified of evictions. */
+@property(nonatomic, weak, nullable) id<YTPlayerBudgetManagerDelegate> delegate;
+
+/** Adds |playerView| to the players accounted for, initially off screen and never used. */
+- (void)registerPlayerView:(nonnull YTPlayerView *)playerView;
+
+/** Removes |playerView| without evicting it. */
+- (void)unregisterPlayerView:(nonnull YTPlayerView *)playerView;
+
+/** Records whether |playerView| is currently on screen. */
+- (void)setVisible:(BOOL)visible forPlayerView:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Records that the user interacted with |playerView|, e.g. started it or scrolled to it.
+ *
+ * @param playerView A registered player.
+ * @param time The current time, e.g. from CACurrentMediaTime().
+ */
+- (void)notePlayerViewUsed:(nonnull YTPlayerView *)playerView atTime:(CFTimeInterval)time;
+
+/**
+ * Returns the estimated cost of |playerView| in its current state.
+ *
+ * @param playerView A registered player.
+ * @return The cost, or 0 if |playerView| is not registered.
+ */
+- (double)costOfPlayerView:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Evicts players until the total cost is within the budget.
+ *
+ * @return The evicted players, in eviction order.
+ */
+- (nonnull NSArray<YTPlayerView *> *)enforceBudget;
+
+/**
+ * Restores a hibernated player with YTPlayerView::restoreFromHibernation, marks it used at
+ * |time| and then evicts other players as needed to make room for it.
+ *
+ * @param playerView A registered player.
+ * @param time The current time, e.g. from CACurrentMediaTime().
+ * @return YES if the player has been restored.
+ */
+- (BOOL)restorePlayerView:(nonnull YTPlayerView *)playerView atTime:(CFTimeInterval)time;
+
+/**
+ * Evicts every player except those that are both visible and playing. Called automatically on
+ * UIApplicationDidReceiveMemoryWarningNotification.
+ *
+ * @return The evicted players, in eviction order.
+ */
+- (nonnull NSArray<YTPlayerView *> *)handleMemoryWarning;
+
+@end
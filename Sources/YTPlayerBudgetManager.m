@@ -0,0 +1,236 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerBudgetManager.h"
+
+#import "YTPlayerView.h"
+
+/** A registered player and what the manager knows about its use. */
+@interface YTPlayerBudgetEntry : NSObject
+
+@property(nonatomic, weak) YTPlayerView *playerView;
+@property(nonatomic) BOOL visible;
+@property(nonatomic) CFTimeInterval lastUsedTime;
+
+@end
+
+@implementation YTPlayerBudgetEntry
+@end
+
+@implementation YTPlayerBudgetManager {
+  // Entries in registration order, which is also the tie-breaking eviction order.
+  NSMutableArray<YTPlayerBudgetEntry *> *_entries;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _entries = [[NSMutableArray alloc] init];
+    _budget = 3;
+    _webViewCost = 1;
+    _playingCost = 1;
+    _visibleCost = 0.25;
+    [[NSNotificationCenter defaultCenter]
+        addObserver:self
+           selector:@selector(applicationDidReceiveMemoryWarning:)
+               name:UIApplicationDidReceiveMemoryWarningNotification
+             object:nil];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)registerPlayerView:(YTPlayerView *)playerView {
+  if ([self entryForPlayerView:playerView]) {
+    return;
+  }
+  YTPlayerBudgetEntry *entry = [[YTPlayerBudgetEntry alloc] init];
+  entry.playerView = playerView;
+  entry.lastUsedTime = -DBL_MAX;
+  [_entries addObject:entry];
+}
+
+- (void)unregisterPlayerView:(YTPlayerView *)playerView {
+  YTPlayerBudgetEntry *entry = [self entryForPlayerView:playerView];
+  if (entry) {
+    [_entries removeObject:entry];
+  }
+}
+
+- (void)setVisible:(BOOL)visible forPlayerView:(YTPlayerView *)playerView {
+  [self entryForPlayerView:playerView].visible = visible;
+}
+
+- (void)notePlayerViewUsed:(YTPlayerView *)playerView atTime:(CFTimeInterval)time {
+  [self entryForPlayerView:playerView].lastUsedTime = time;
+}
+
+- (double)costOfPlayerView:(YTPlayerView *)playerView {
+  YTPlayerBudgetEntry *entry = [self entryForPlayerView:playerView];
+  return entry ? [self costOfEntry:entry] : 0;
+}
+
+- (double)totalCost {
+  double totalCost = 0;
+  for (YTPlayerBudgetEntry *entry in _entries) {
+    totalCost += [self costOfEntry:entry];
+  }
+  return totalCost;
+}
+
+- (NSArray<YTPlayerView *> *)enforceBudget {
+  return [self evictExcludingPlayerView:nil untilWithinBudget:YES];
+}
+
+- (BOOL)restorePlayerView:(YTPlayerView *)playerView atTime:(CFTimeInterval)time {
+  YTPlayerBudgetEntry *entry = [self entryForPlayerView:playerView];
+  if (!entry || ![playerView restoreFromHibernation]) {
+    return NO;
+  }
+  entry.lastUsedTime = time;
+  [self evictExcludingPlayerView:playerView untilWithinBudget:YES];
+  return YES;
+}
+
+- (NSArray<YTPlayerView *> *)handleMemoryWarning {
+  return [self evictExcludingPlayerView:nil untilWithinBudget:NO];
+}
+
+#pragma mark - Private methods
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification {
+  [self handleMemoryWarning];
+}
+
+- (YTPlayerBudgetEntry *)entryForPlayerView:(YTPlayerView *)playerView {
+  for (YTPlayerBudgetEntry *entry in _entries) {
+    if (entry.playerView == playerView) {
+      return entry;
+    }
+  }
+  return nil;
+}
+
+- (BOOL)isEntryPlaying:(YTPlayerBudgetEntry *)entry {
+  YTPlayerState state = entry.playerView.lastReportedState;
+  return state == kYTPlayerStatePlaying || state == kYTPlayerStateBuffering;
+}
+
+- (double)costOfEntry:(YTPlayerBudgetEntry *)entry {
+  YTPlayerView *playerView = entry.playerView;
+  if (!playerView.webView || playerView.hibernating) {
+    return 0;
+  }
+  double cost = self.webViewCost;
+  if ([self isEntryPlaying:entry]) {
+    cost += self.playingCost;
+  }
+  if (entry.visible) {
+    cost += self.visibleCost;
+  }
+  return cost;
+}
+
+/**
+ * Private method evicting players in order of how cheap they are to restore.
+ *
+ * @param excludedPlayerView A player that must not be evicted, or nil.
+ * @param untilWithinBudget YES to stop as soon as the total cost is within the budget, NO to
+ *                          evict every player that is not both visible and playing.
+ * @return The evicted players, in eviction order.
+ */
+- (NSArray<YTPlayerView *> *)evictExcludingPlayerView:(YTPlayerView *)excludedPlayerView
+                                    untilWithinBudget:(BOOL)untilWithinBudget {
+  [self removeReleasedEntries];
+
+  double totalCost = 0;
+  NSMutableArray<YTPlayerBudgetEntry *> *candidates = [NSMutableArray array];
+  for (YTPlayerBudgetEntry *entry in _entries) {
+    double cost = [self costOfEntry:entry];
+    totalCost += cost;
+    if (cost > 0 && entry.playerView != excludedPlayerView) {
+      [candidates addObject:entry];
+    }
+  }
+  if (untilWithinBudget && totalCost <= self.budget) {
+    return @[];
+  }
+
+  // Off-screen before visible, paused before playing, least recently used first. The sort is
+  // stable, so registration order breaks the remaining ties.
+  [candidates sortWithOptions:NSSortStable
+              usingComparator:^NSComparisonResult(YTPlayerBudgetEntry *a, YTPlayerBudgetEntry *b) {
+                if (a.visible != b.visible) {
+                  return a.visible ? NSOrderedDescending : NSOrderedAscending;
+                }
+                BOOL aPlaying = [self isEntryPlaying:a];
+                BOOL bPlaying = [self isEntryPlaying:b];
+                if (aPlaying != bPlaying) {
+                  return aPlaying ? NSOrderedDescending : NSOrderedAscending;
+                }
+                if (a.lastUsedTime != b.lastUsedTime) {
+                  return a.lastUsedTime < b.lastUsedTime ? NSOrderedAscending
+                                                         : NSOrderedDescending;
+                }
+                return NSOrderedSame;
+              }];
+
+  NSMutableArray<YTPlayerView *> *evicted = [NSMutableArray array];
+  for (YTPlayerBudgetEntry *entry in candidates) {
+    if (untilWithinBudget && totalCost <= self.budget) {
+      break;
+    }
+    if (!untilWithinBudget && entry.visible && [self isEntryPlaying:entry]) {
+      continue;
+    }
+    double cost = [self costOfEntry:entry];
+    YTPlayerView *playerView = entry.playerView;
+    [self evictEntry:entry];
+    totalCost -= cost - [self costOfEntry:entry];
+    [evicted addObject:playerView];
+  }
+  return evicted;
+}
+
+- (void)evictEntry:(YTPlayerBudgetEntry *)entry {
+  YTPlayerView *playerView = entry.playerView;
+  YTPlayerEvictionAction action = kYTPlayerEvictionActionHibernate;
+  if ([self.delegate respondsToSelector:@selector(budgetManager:actionForEvictingPlayerView:)]) {
+    action = [self.delegate budgetManager:self actionForEvictingPlayerView:playerView];
+  }
+  if (action == kYTPlayerEvictionActionHibernate && ![playerView hibernate]) {
+    action = kYTPlayerEvictionActionDestroy;
+  }
+  if (action == kYTPlayerEvictionActionDestroy) {
+    [playerView removeWebView];
+    [_entries removeObject:entry];
+  }
+  if ([self.delegate respondsToSelector:@selector(budgetManager:didEvictPlayerView:withAction:)]) {
+    [self.delegate budgetManager:self didEvictPlayerView:playerView withAction:action];
+  }
+}
+
+- (void)removeReleasedEntries {
+  NSIndexSet *releasedEntries =
+      [_entries indexesOfObjectsPassingTest:^BOOL(YTPlayerBudgetEntry *entry, NSUInteger index,
+                                                  BOOL *stop) {
+        return entry.playerView == nil;
+      }];
+  [_entries removeObjectsAtIndexes:releasedEntries];
+}
+
+@end
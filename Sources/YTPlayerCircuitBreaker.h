@@ -0,0 +1,77 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** These enums represent the states of a YTPlayerCircuitBreaker. */
+typedef NS_ENUM(NSInteger, YTPlayerCircuitBreakerState) {
+    kYTPlayerCircuitBreakerStateClosed,   // Attempts are allowed.
+    kYTPlayerCircuitBreakerStateOpen,     // Attempts fail fast until the cooldown has passed.
+    kYTPlayerCircuitBreakerStateHalfOpen  // A single probe attempt is in flight.
+};
+
+/**
+ * YTPlayerCircuitBreaker stops players from loading the iframe API while it is known to be
+ * unreachable. After YTPlayerCircuitBreaker::failureThreshold consecutive failures the breaker
+ * opens, and attempts fail fast instead of creating a web view and waiting for the network. Once
+ * YTPlayerCircuitBreaker::cooldown has passed, the next attempt is let through as a probe while
+ * any others keep failing fast; its success closes the breaker and its failure opens it again.
+ * A probe that reports nothing within another cooldown counts as abandoned, so a stalled load
+ * cannot keep the breaker half-open forever.
+ *
+ * YTPlayerView consults YTPlayerCircuitBreaker::sharedBreaker before each standalone load, so
+ * all players of the process share its view of the iframe API. The breaker should only be used
+ * from the main thread. Times are in seconds on a monotonic clock such as CACurrentMediaTime().
+ */
+@interface YTPlayerCircuitBreaker : NSObject
+
+/** The breaker shared by all players that do not have their own. */
++ (nonnull YTPlayerCircuitBreaker *)sharedBreaker;
+
+/** The number of consecutive failures that opens the breaker. Defaults to 3. */
+@property(nonatomic) NSUInteger failureThreshold;
+
+/** How long the breaker stays open before letting a probe through. Defaults to 30 seconds. */
+@property(nonatomic) NSTimeInterval cooldown;
+
+@property(nonatomic, readonly) YTPlayerCircuitBreakerState state;
+
+/** The number of failures since the last success. */
+@property(nonatomic, readonly) NSUInteger consecutiveFailureCount;
+
+/**
+ * Returns whether an attempt may be made at |time|. An attempt allowed while the breaker is
+ * open makes it half-open; its outcome must then be reported with one of the record methods.
+ */
+- (BOOL)shouldAttemptAtTime:(NSTimeInterval)time;
+
+/** Records that an attempt succeeded, closing the breaker. */
+- (void)recordSuccess;
+
+/**
+ * Records that an attempt failed at |time|. Failures reported while the breaker is open, e.g. of
+ * attempts made before it opened, do not restart its cooldown.
+ */
+- (void)recordFailureAtTime:(NSTimeInterval)time;
+
+/**
+ * Records that an attempt was given up before its outcome was known, e.g. because its player
+ * was released. An abandoned probe lets the next attempt probe instead.
+ */
+- (void)recordAbandonedAttempt;
+
+/** Closes the breaker and forgets past failures. */
+- (void)reset;
+
+@end
@@ -0,0 +1,95 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerCircuitBreaker.h"
+
+@implementation YTPlayerCircuitBreaker {
+  // When the breaker last opened.
+  NSTimeInterval _openedAt;
+  // When the probe in flight while half-open was let through.
+  NSTimeInterval _probeStartedAt;
+}
+
++ (YTPlayerCircuitBreaker *)sharedBreaker {
+  static YTPlayerCircuitBreaker *sharedBreaker = nil;
+  static dispatch_once_t predicate;
+  dispatch_once(&predicate, ^{
+    sharedBreaker = [[YTPlayerCircuitBreaker alloc] init];
+  });
+  return sharedBreaker;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _failureThreshold = 3;
+    _cooldown = 30;
+  }
+  return self;
+}
+
+- (BOOL)shouldAttemptAtTime:(NSTimeInterval)time {
+  switch (self.state) {
+    case kYTPlayerCircuitBreakerStateClosed:
+      return YES;
+    case kYTPlayerCircuitBreakerStateOpen:
+      if (time - _openedAt < self.cooldown) {
+        return NO;
+      }
+      _state = kYTPlayerCircuitBreakerStateHalfOpen;
+      _probeStartedAt = time;
+      return YES;
+    case kYTPlayerCircuitBreakerStateHalfOpen:
+      // A probe that has not reported within a cooldown, e.g. because its load stalled, is
+      // considered abandoned and this attempt probes instead.
+      if (time - _probeStartedAt < self.cooldown) {
+        return NO;
+      }
+      _probeStartedAt = time;
+      return YES;
+  }
+  return NO;
+}
+
+- (void)recordSuccess {
+  _state = kYTPlayerCircuitBreakerStateClosed;
+  _consecutiveFailureCount = 0;
+}
+
+- (void)recordFailureAtTime:(NSTimeInterval)time {
+  _consecutiveFailureCount++;
+  // Late failures of attempts made before the breaker opened must not extend its cooldown.
+  if (self.state == kYTPlayerCircuitBreakerStateOpen) {
+    return;
+  }
+  if (self.state == kYTPlayerCircuitBreakerStateHalfOpen ||
+      _consecutiveFailureCount >= self.failureThreshold) {
+    _state = kYTPlayerCircuitBreakerStateOpen;
+    _openedAt = time;
+  }
+}
+
+- (void)recordAbandonedAttempt {
+  if (self.state == kYTPlayerCircuitBreakerStateHalfOpen) {
+    // The cooldown has already passed, so the next attempt probes right away.
+    _state = kYTPlayerCircuitBreakerStateOpen;
+  }
+}
+
+- (void)reset {
+  _state = kYTPlayerCircuitBreakerStateClosed;
+  _consecutiveFailureCount = 0;
+}
+
+@end
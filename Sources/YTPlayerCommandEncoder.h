@@ -0,0 +1,84 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Opcodes of the player commands understood by dispatchCommands() in the player page. Each one
+ * calls the YT.Player method of the same name. The values index the commandMethods table of the
+ * page and must stay in sync with it.
+ */
+typedef NS_ENUM(NSInteger, YTPlayerOpcode) {
+  kYTPlayerOpcodePlayVideo = 1,
+  kYTPlayerOpcodePauseVideo,
+  kYTPlayerOpcodeStopVideo,
+  kYTPlayerOpcodeSeekTo,
+  kYTPlayerOpcodeCueVideoById,
+  kYTPlayerOpcodeLoadVideoById,
+  kYTPlayerOpcodeCueVideoByUrl,
+  kYTPlayerOpcodeLoadVideoByUrl,
+  kYTPlayerOpcodeCuePlaylist,
+  kYTPlayerOpcodeLoadPlaylist,
+  kYTPlayerOpcodeNextVideo,
+  kYTPlayerOpcodePreviousVideo,
+  kYTPlayerOpcodePlayVideoAt,
+  kYTPlayerOpcodeSetPlaybackRate,
+  kYTPlayerOpcodeSetLoop,
+  kYTPlayerOpcodeSetShuffle,
+  kYTPlayerOpcodeSetSphericalProperties
+};
+
+/** The largest valid YTPlayerOpcode. */
+extern const YTPlayerOpcode kYTPlayerOpcodeMax;
+
+/**
+ * YTPlayerCommandEncoder collects player commands into a batch for dispatchCommands() in the
+ * player page. A batch is an array of commands, and each command is an array holding the opcode
+ * followed by the method's arguments as JSON-compatible values. The batch is passed to the page
+ * as an argument rather than as generated source, so the page never has to parse a new script
+ * per command.
+ */
+@interface YTPlayerCommandEncoder : NSObject
+
+/** The commands appended since the last YTPlayerCommandEncoder::removeAllCommands. */
+@property(nonatomic, readonly, nonnull) NSArray<NSArray *> *commands;
+
+/**
+ * Appends a command to the batch.
+ *
+ * @param opcode The command.
+ * @param arguments The arguments of the YT.Player method, or nil for none.
+ * @return NO, leaving the batch unchanged, if the arguments cannot be represented as JSON, e.g.
+ *         because one of them is NaN.
+ */
+- (BOOL)appendCommand:(YTPlayerOpcode)opcode arguments:(nullable NSArray *)arguments;
+
+/** Empties the batch. */
+- (void)removeAllCommands;
+
+/**
+ * Returns a script dispatching the batch, for web views that cannot pass it as an argument.
+ * Only the JSON literal of the batch varies between scripts.
+ *
+ * @return A script of the form dispatchCommands([...]);, or nil if the arguments cannot be
+ *         represented as JSON.
+ */
+- (nullable NSString *)javaScriptSource;
+
+/**
+ * Returns the YT.Player method called for |opcode|.
+ */
++ (nonnull NSString *)methodNameForOpcode:(YTPlayerOpcode)opcode;
+
+@end
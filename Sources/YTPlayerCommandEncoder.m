@@ -0,0 +1,101 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerCommandEncoder.h"
+
+const YTPlayerOpcode kYTPlayerOpcodeMax = kYTPlayerOpcodeSetSphericalProperties;
+
+@implementation YTPlayerCommandEncoder {
+  NSMutableArray<NSArray *> *_commands;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _commands = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (NSArray<NSArray *> *)commands {
+  return [_commands copy];
+}
+
+- (BOOL)appendCommand:(YTPlayerOpcode)opcode arguments:(NSArray *)arguments {
+  NSMutableArray *command = [[NSMutableArray alloc] initWithCapacity:arguments.count + 1];
+  [command addObject:@(opcode)];
+  if (arguments) {
+    [command addObjectsFromArray:arguments];
+  }
+  if (![NSJSONSerialization isValidJSONObject:@[ command ]]) {
+    return NO;
+  }
+  [_commands addObject:command];
+  return YES;
+}
+
+- (void)removeAllCommands {
+  [_commands removeAllObjects];
+}
+
+- (NSString *)javaScriptSource {
+  if (![NSJSONSerialization isValidJSONObject:_commands]) {
+    return nil;
+  }
+  NSData *data = [NSJSONSerialization dataWithJSONObject:_commands options:0 error:nil];
+  NSString *batchJSON = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  return [NSString stringWithFormat:@"dispatchCommands(%@);", batchJSON];
+}
+
++ (NSString *)methodNameForOpcode:(YTPlayerOpcode)opcode {
+  switch (opcode) {
+    case kYTPlayerOpcodePlayVideo:
+      return @"playVideo";
+    case kYTPlayerOpcodePauseVideo:
+      return @"pauseVideo";
+    case kYTPlayerOpcodeStopVideo:
+      return @"stopVideo";
+    case kYTPlayerOpcodeSeekTo:
+      return @"seekTo";
+    case kYTPlayerOpcodeCueVideoById:
+      return @"cueVideoById";
+    case kYTPlayerOpcodeLoadVideoById:
+      return @"loadVideoById";
+    case kYTPlayerOpcodeCueVideoByUrl:
+      return @"cueVideoByUrl";
+    case kYTPlayerOpcodeLoadVideoByUrl:
+      return @"loadVideoByUrl";
+    case kYTPlayerOpcodeCuePlaylist:
+      return @"cuePlaylist";
+    case kYTPlayerOpcodeLoadPlaylist:
+      return @"loadPlaylist";
+    case kYTPlayerOpcodeNextVideo:
+      return @"nextVideo";
+    case kYTPlayerOpcodePreviousVideo:
+      return @"previousVideo";
+    case kYTPlayerOpcodePlayVideoAt:
+      return @"playVideoAt";
+    case kYTPlayerOpcodeSetPlaybackRate:
+      return @"setPlaybackRate";
+    case kYTPlayerOpcodeSetLoop:
+      return @"setLoop";
+    case kYTPlayerOpcodeSetShuffle:
+      return @"setShuffle";
+    case kYTPlayerOpcodeSetSphericalProperties:
+      return @"setSphericalProperties";
+  }
+  return @"";
+}
+
+@end
@@ -0,0 +1,145 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+#import "YTPlayerInitialState.h"
+
+@class YTPlayerConfiguration;
+
+/** Error domain for configurations rejected by YTPlayerConfigurationBuilder::buildWithError:. */
+FOUNDATION_EXPORT NSString *_Nonnull const YTPlayerConfigurationErrorDomain;
+
+/**
+ * Returns |string| as a quoted JSON string literal, for splicing values into pre-serialized
+ * player parameters.
+ */
+FOUNDATION_EXPORT NSString *_Nonnull YTJSONStringLiteral(NSString *_Nonnull string);
+
+/** These enums represent the reasons a configuration can fail validation. */
+typedef NS_ENUM(NSInteger, YTPlayerConfigurationError) {
+    kYTPlayerConfigurationErrorInvalidStartSeconds,
+    kYTPlayerConfigurationErrorInvalidEndSeconds,
+    kYTPlayerConfigurationErrorInvalidPlaylist,
+    kYTPlayerConfigurationErrorInvalidPlayerVars,
+    kYTPlayerConfigurationErrorInvalidInitialState
+};
+
+/**
+ * A mutable builder for YTPlayerConfiguration. Each property corresponds to a player parameter
+ * documented at:
+ *   https://developers.google.com/youtube/player_parameters?playerVersion=HTML5
+ *
+ * Properties left at their default value are not sent to the player, so the player's own
+ * defaults apply.
+ */
+@interface YTPlayerConfigurationBuilder : NSObject
+
+/** Whether the player controls are displayed ("controls"). Defaults to YES. */
+@property(nonatomic) BOOL showsControls;
+
+/** Whether videos play inline rather than fullscreen ("playsinline"). Defaults to NO. */
+@property(nonatomic) BOOL playsInline;
+
+/** Whether the video starts playing as soon as it is loaded ("autoplay"). Defaults to NO. */
+@property(nonatomic) BOOL autoplay;
+
+/** Time in seconds to start playing the video from ("start"). Defaults to 0. */
+@property(nonatomic) NSInteger startSeconds;
+
+/** Time in seconds to stop playing the video at ("end"). Defaults to 0, meaning no end time. */
+@property(nonatomic) NSInteger endSeconds;
+
+/**
+ * Whether the video or playlist loops ("loop"). When loading a single video without a
+ * |playlist|, the video ID is used as the playlist, as the player requires. Defaults to NO.
+ */
+@property(nonatomic) BOOL loop;
+
+/** Video IDs to play after the loaded video ("playlist"). Defaults to nil. */
+@property(nonatomic, copy, nullable) NSArray<NSString *> *playlist;
+
+/** Whether the YouTube logo is hidden from the control bar ("modestbranding"). Defaults to NO. */
+@property(nonatomic) BOOL modestBranding;
+
+/** Whether the fullscreen button is displayed ("fs"). Defaults to YES. */
+@property(nonatomic) BOOL showsFullscreenButton;
+
+/** Whether the player responds to keyboard controls ("disablekb"). Defaults to YES. */
+@property(nonatomic) BOOL keyboardEnabled;
+
+/** Whether closed captions are shown by default ("cc_load_policy"). Defaults to NO. */
+@property(nonatomic) BOOL showsClosedCaptions;
+
+/**
+ * Whether related videos may come from any channel rather than only the video's own channel
+ * ("rel"). Defaults to YES.
+ */
+@property(nonatomic) BOOL showsRelatedVideosFromAnyChannel;
+
+/** ISO 639-1 language code for the player interface ("hl"). Defaults to nil. */
+@property(nonatomic, copy, nullable) NSString *interfaceLanguage;
+
+/**
+ * Player parameters that have no typed property above. Typed properties take precedence over
+ * entries in this dictionary. The "origin" parameter is always set by YTPlayerView.
+ */
+@property(nonatomic, copy, nullable) NSDictionary<NSString *, id> *additionalPlayerVars;
+
+/** State to apply inside the page once the player is ready. Defaults to nil. */
+@property(nonatomic, copy, nullable) YTPlayerInitialState *initialState;
+
+/**
+ * Validates the builder's properties and returns an immutable configuration with its player
+ * parameters already serialized.
+ *
+ * @param error On failure, an error in YTPlayerConfigurationErrorDomain.
+ * @return A configuration, or nil if validation failed.
+ */
+- (nullable YTPlayerConfiguration *)buildWithError:(NSError *_Nullable *_Nullable)error;
+
+@end
+
+/**
+ * An immutable, validated set of player parameters. A configuration is serialized once when it
+ * is built and can be reused across any number of loads with
+ * YTPlayerView::loadWithVideoId:configuration:, so that each load only has to splice in the
+ * video ID and origin.
+ */
+@interface YTPlayerConfiguration : NSObject
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/** Whether the configuration loops playback. */
+@property(nonatomic, readonly) BOOL loop;
+
+/** Whether the configuration specifies an explicit playlist. */
+@property(nonatomic, readonly) BOOL hasPlaylist;
+
+/** The serialized initial state, or "null" when none was configured. */
+@property(nonatomic, readonly, nonnull) NSString *initialStateJSON;
+
+/**
+ * Returns the serialized playerVars object with the given origin. The result for the most
+ * recently used origin is cached, so repeated loads from the same YTPlayerView do not
+ * serialize anything.
+ *
+ * @param origin The origin URL string of the player page.
+ * @param playlistVideoId A video ID to use as the playlist when looping a single video, or nil.
+ * @return A JSON object literal.
+ */
+- (nonnull NSString *)playerVarsJSONWithOrigin:(nonnull NSString *)origin
+                               playlistVideoId:(nullable NSString *)playlistVideoId;
+
+@end
@@ -0,0 +1,214 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerConfiguration.h"
+
+NSString *const YTPlayerConfigurationErrorDomain = @"YTPlayerConfigurationErrorDomain";
+
+NSString *YTJSONStringLiteral(NSString *string) {
+  // NSJSONSerialization only accepts top-level fragments from iOS 11, so wrap the string in an
+  // array and strip the brackets.
+  NSData *data = [NSJSONSerialization dataWithJSONObject:@[ string ] options:0 error:nil];
+  NSString *array = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  return [array substringWithRange:NSMakeRange(1, array.length - 2)];
+}
+
+@interface YTPlayerConfiguration ()
+
+/** The serialized playerVars without their closing brace, e.g. '{"controls":0,'. */
+@property(nonatomic, copy) NSString *playerVarsJSONPrefix;
+@property(nonatomic) BOOL loop;
+@property(nonatomic) BOOL hasPlaylist;
+@property(nonatomic, copy) NSString *initialStateJSON;
+
+- (instancetype)initWithPlayerVarsJSONPrefix:(NSString *)playerVarsJSONPrefix
+                            initialStateJSON:(NSString *)initialStateJSON;
+
+@end
+
+@implementation YTPlayerConfiguration {
+  NSString *_cachedOrigin;
+  NSString *_cachedPlayerVarsJSON;
+}
+
+- (instancetype)initWithPlayerVarsJSONPrefix:(NSString *)playerVarsJSONPrefix
+                            initialStateJSON:(NSString *)initialStateJSON {
+  self = [super init];
+  if (self) {
+    _playerVarsJSONPrefix = [playerVarsJSONPrefix copy];
+    _initialStateJSON = [initialStateJSON copy];
+  }
+  return self;
+}
+
+- (NSString *)playerVarsJSONWithOrigin:(NSString *)origin
+                       playlistVideoId:(NSString *)playlistVideoId {
+  if (playlistVideoId) {
+    // Looping a single video requires the video itself to be the playlist, which changes with
+    // every load and therefore bypasses the cache.
+    return [NSString stringWithFormat:@"%@\"playlist\":%@,\"origin\":%@}",
+                                      self.playerVarsJSONPrefix,
+                                      YTJSONStringLiteral(playlistVideoId),
+                                      YTJSONStringLiteral(origin)];
+  }
+  @synchronized(self) {
+    if (![_cachedOrigin isEqualToString:origin]) {
+      _cachedOrigin = [origin copy];
+      _cachedPlayerVarsJSON = [NSString stringWithFormat:@"%@\"origin\":%@}",
+                                                         self.playerVarsJSONPrefix,
+                                                         YTJSONStringLiteral(origin)];
+    }
+    return _cachedPlayerVarsJSON;
+  }
+}
+
+@end
+
+@implementation YTPlayerConfigurationBuilder
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _showsControls = YES;
+    _showsFullscreenButton = YES;
+    _keyboardEnabled = YES;
+    _showsRelatedVideosFromAnyChannel = YES;
+  }
+  return self;
+}
+
+- (YTPlayerConfiguration *)buildWithError:(NSError **)error {
+  if (self.startSeconds < 0) {
+    [self setError:error
+              code:kYTPlayerConfigurationErrorInvalidStartSeconds
+       description:@"startSeconds must not be negative."];
+    return nil;
+  }
+  if (self.endSeconds < 0 || (self.endSeconds > 0 && self.endSeconds <= self.startSeconds)) {
+    [self setError:error
+              code:kYTPlayerConfigurationErrorInvalidEndSeconds
+       description:@"endSeconds must be after startSeconds."];
+    return nil;
+  }
+  NSCharacterSet *invalidVideoIdCharacters = [[NSCharacterSet characterSetWithCharactersInString:
+      @"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"] invertedSet];
+  for (NSString *videoId in self.playlist) {
+    if (![videoId isKindOfClass:[NSString class]] || videoId.length == 0 ||
+        [videoId rangeOfCharacterFromSet:invalidVideoIdCharacters].location != NSNotFound) {
+      [self setError:error
+                code:kYTPlayerConfigurationErrorInvalidPlaylist
+         description:[NSString stringWithFormat:@"Invalid video ID in playlist: %@", videoId]];
+      return nil;
+    }
+  }
+
+  NSMutableDictionary *playerVars = [[NSMutableDictionary alloc] init];
+  if (self.additionalPlayerVars) {
+    [playerVars addEntriesFromDictionary:self.additionalPlayerVars];
+  }
+  [playerVars removeObjectForKey:@"origin"];
+  // Only parameters that differ from the player's defaults are sent.
+  if (!self.showsControls) {
+    playerVars[@"controls"] = @0;
+  }
+  if (self.playsInline) {
+    playerVars[@"playsinline"] = @1;
+  }
+  if (self.autoplay) {
+    playerVars[@"autoplay"] = @1;
+  }
+  if (self.startSeconds > 0) {
+    playerVars[@"start"] = @(self.startSeconds);
+  }
+  if (self.endSeconds > 0) {
+    playerVars[@"end"] = @(self.endSeconds);
+  }
+  if (self.loop) {
+    playerVars[@"loop"] = @1;
+  }
+  if (self.playlist.count > 0) {
+    playerVars[@"playlist"] = [self.playlist componentsJoinedByString:@","];
+  }
+  if (self.modestBranding) {
+    playerVars[@"modestbranding"] = @1;
+  }
+  if (!self.showsFullscreenButton) {
+    playerVars[@"fs"] = @0;
+  }
+  if (!self.keyboardEnabled) {
+    playerVars[@"disablekb"] = @1;
+  }
+  if (self.showsClosedCaptions) {
+    playerVars[@"cc_load_policy"] = @1;
+  }
+  if (!self.showsRelatedVideosFromAnyChannel) {
+    playerVars[@"rel"] = @0;
+  }
+  if (self.interfaceLanguage.length > 0) {
+    playerVars[@"hl"] = self.interfaceLanguage;
+  }
+
+  if (![NSJSONSerialization isValidJSONObject:playerVars]) {
+    [self setError:error
+              code:kYTPlayerConfigurationErrorInvalidPlayerVars
+       description:[NSString stringWithFormat:@"Invalid playerVars: %@", playerVars]];
+    return nil;
+  }
+  NSData *playerVarsData = [NSJSONSerialization dataWithJSONObject:playerVars
+                                                           options:0
+                                                             error:nil];
+  NSMutableString *playerVarsJSONPrefix =
+      [[NSMutableString alloc] initWithData:playerVarsData encoding:NSUTF8StringEncoding];
+  // Drop the closing brace so the origin can be appended at load time.
+  [playerVarsJSONPrefix deleteCharactersInRange:NSMakeRange(playerVarsJSONPrefix.length - 1, 1)];
+  if (playerVars.count > 0) {
+    [playerVarsJSONPrefix appendString:@","];
+  }
+
+  NSString *initialStateJSON = @"null";
+  if (self.initialState) {
+    NSDictionary *initialState = [self.initialState dictionaryRepresentation];
+    if (![NSJSONSerialization isValidJSONObject:initialState]) {
+      [self setError:error
+                code:kYTPlayerConfigurationErrorInvalidInitialState
+         description:[NSString stringWithFormat:@"Invalid initialState: %@", initialState]];
+      return nil;
+    }
+    NSData *initialStateData = [NSJSONSerialization dataWithJSONObject:initialState
+                                                               options:0
+                                                                 error:nil];
+    initialStateJSON = [[NSString alloc] initWithData:initialStateData
+                                             encoding:NSUTF8StringEncoding];
+  }
+
+  YTPlayerConfiguration *configuration =
+      [[YTPlayerConfiguration alloc] initWithPlayerVarsJSONPrefix:playerVarsJSONPrefix
+                                                 initialStateJSON:initialStateJSON];
+  configuration.loop = self.loop;
+  // The playlist may also come from additionalPlayerVars; a looped video must not add another.
+  configuration.hasPlaylist = playerVars[@"playlist"] != nil || playerVars[@"list"] != nil;
+  return configuration;
+}
+
+- (void)setError:(NSError **)error
+            code:(YTPlayerConfigurationError)code
+     description:(NSString *)description {
+  if (error) {
+    *error = [NSError errorWithDomain:YTPlayerConfigurationErrorDomain
+                                 code:code
+                             userInfo:@{ NSLocalizedDescriptionKey : description }];
+  }
+}
+
+@end
@@ -0,0 +1,65 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <UIKit/UIKit.h>
+#import <WebKit/WebKit.h>
+
+/**
+ * YTPlayerHostView hosts several players in a single web view, so that a grid of small players
+ * shares one page, one JavaScript heap and one copy of the iframe API instead of paying for each.
+ *
+ * Players are created with YTPlayerView::initWithHostView: and otherwise used like any other
+ * YTPlayerView: they are loaded, controlled and report to their delegates as usual. A hosted
+ * YTPlayerView does not render anything itself. Lay it out over the host view; the host renders
+ * the player in the region the hosted view covers, and touches on the hosted view fall through to
+ * the host. Call YTPlayerHostView::updatePlayerRegions when hosted views move without being laid
+ * out again, e.g. while scrolling.
+ *
+ * Unlike standalone players, hosted players do not report 360° camera orientation, and
+ * YTPlayerView::servesPageFromMemory has no effect on them. They all load the iframe API and
+ * their embeds from YTPlayerHostView::embedHostURL.
+ *
+ * Until the shared page has loaded the iframe API, commands sent to hosted players are queued and
+ * getters complete with no result and no error, e.g. YTPlayerView::currentTime: reports 0. If
+ * the iframe API fails to load, every hosted player's delegate is told so, and queued and later
+ * commands are dropped.
+ */
+@interface YTPlayerHostView : UIView
+
+/**
+ * Initializes a host view whose page uses |originURL| as its origin. See
+ * YTPlayerView::initWithOriginURL:.
+ */
+- (nonnull instancetype)initWithOriginURL:(nonnull NSURL *)originURL;
+
+/** The origin of the shared page, also passed to every hosted player as its origin. */
+@property(nonatomic, readonly, nonnull) NSURL *originURL;
+
+/**
+ * The host the shared page loads the iframe API and the embeds from, see
+ * YTPlayerView::embedHostURL. Takes effect when the page is loaded with the first hosted player.
+ * Defaults to https://www.youtube.com; set it to nil to reset.
+ */
+@property(nonatomic, null_resettable) NSURL *embedHostURL;
+
+/** The shared web view, created when the first hosted player is loaded. */
+@property(nonatomic, readonly, nullable) WKWebView *webView;
+
+/** The number of players currently attached to this host. */
+@property(nonatomic, readonly) NSUInteger playerCount;
+
+/** Moves every hosted player to the region its YTPlayerView currently covers. */
+- (void)updatePlayerRegions;
+
+@end
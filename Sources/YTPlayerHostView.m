@@ -0,0 +1,351 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerHostView.h"
+
+#import "YTPlayerView.h"
+
+NSString static *const kYTPlayerHostMessageHandlerName = @"ytplayer";
+NSString static *const kYTPlayerHostCallbackOnHostReady = @"onHostReady";
+NSString static *const kYTPlayerHostCallbackOnYouTubeIframeAPIFailedToLoad =
+    @"onYouTubeIframeAPIFailedToLoad";
+NSString static *const kYTPlayerHostDefaultEmbedHost = @"https://www.youtube.com";
+
+/** The parts of YTPlayerView the host routes events and resources through. */
+@interface YTPlayerView (YTPlayerHostView)
+- (void)dispatchYouTubeCallbackUrl:(NSURL *)url;
++ (NSDictionary<NSString *, NSString *> *)parametersForQuery:(NSString *)query;
++ (BOOL)isAllowedNavigationURL:(NSURL *)url;
++ (NSString *)contentsOfResource:(NSString *)name ofType:(NSString *)type;
++ (NSString *)bridgeScript;
++ (NSString *)embedHostOfURL:(NSURL *)embedHostURL;
++ (BOOL)isURL:(NSURL *)url onEmbedHostURL:(NSURL *)embedHostURL;
+@end
+
+/**
+ * Forwards script messages to a weakly held handler, since a WKUserContentController retains its
+ * message handlers and would otherwise keep the host view alive.
+ */
+@interface YTWeakScriptMessageHandler : NSObject <WKScriptMessageHandler>
+
+@property(nonatomic, weak) id<WKScriptMessageHandler> handler;
+
+@end
+
+@implementation YTWeakScriptMessageHandler
+
+- (void)userContentController:(WKUserContentController *)userContentController
+      didReceiveScriptMessage:(WKScriptMessage *)message {
+  [self.handler userContentController:userContentController didReceiveScriptMessage:message];
+}
+
+@end
+
+@interface YTPlayerHostView () <WKNavigationDelegate, WKScriptMessageHandler>
+
+@property(nonatomic) WKWebView *webView;
+
+@end
+
+@implementation YTPlayerHostView {
+  NSURL *_originURL;
+  // Hosted players by player ID. Players detach themselves when they are deallocated.
+  NSMapTable<NSString *, YTPlayerView *> *_playerViews;
+  // The region last sent to the page for each player ID.
+  NSMutableDictionary<NSString *, NSValue *> *_playerRegions;
+  // Scripts evaluated before the iframe API finished loading, in order.
+  NSMutableArray<NSString *> *_pendingScripts;
+  BOOL _hostReady;
+  // Whether the iframe API failed to load, after which the page never becomes ready.
+  BOOL _hostFailed;
+  NSUInteger _lastPlayerNumber;
+}
+
+- (instancetype)initWithFrame:(CGRect)frame {
+  self = [super initWithFrame:frame];
+  if (self) {
+    [self commonInit];
+  }
+  return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)coder {
+  self = [super initWithCoder:coder];
+  if (self) {
+    [self commonInit];
+  }
+  return self;
+}
+
+- (instancetype)initWithOriginURL:(NSURL *)originURL {
+  self = [self initWithFrame:CGRectZero];
+  if (self) {
+    _originURL = originURL;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [_webView.configuration.userContentController
+      removeScriptMessageHandlerForName:kYTPlayerHostMessageHandlerName];
+}
+
+- (void)commonInit {
+  _playerViews = [NSMapTable strongToWeakObjectsMapTable];
+  _playerRegions = [[NSMutableDictionary alloc] init];
+  _pendingScripts = [[NSMutableArray alloc] init];
+}
+
+- (NSURL *)originURL {
+  if (!_originURL) {
+    NSString *bundleId = [[NSBundle mainBundle] bundleIdentifier];
+    NSString *stringURL = [[NSString stringWithFormat:@"http://%@", bundleId] lowercaseString];
+    _originURL = [NSURL URLWithString:stringURL];
+  }
+  return _originURL;
+}
+
+- (NSURL *)embedHostURL {
+  if (!_embedHostURL) {
+    _embedHostURL = [NSURL URLWithString:kYTPlayerHostDefaultEmbedHost];
+  }
+  return _embedHostURL;
+}
+
+- (NSUInteger)playerCount {
+  NSUInteger playerCount = 0;
+  for (YTPlayerView *playerView in _playerViews.objectEnumerator) {
+    if (playerView) {
+      playerCount++;
+    }
+  }
+  return playerCount;
+}
+
+- (void)updatePlayerRegions {
+  for (YTPlayerView *playerView in _playerViews.objectEnumerator) {
+    [self updateRegionOfPlayerView:playerView];
+  }
+}
+
+#pragma mark - Hosted players
+
+// These methods are called by YTPlayerView.
+
+- (NSString *)attachPlayerView:(YTPlayerView *)playerView {
+  _lastPlayerNumber++;
+  NSString *playerId = [NSString stringWithFormat:@"p%lu", (unsigned long)_lastPlayerNumber];
+  [_playerViews setObject:playerView forKey:playerId];
+  return playerId;
+}
+
+- (void)detachPlayerWithId:(NSString *)playerId {
+  [_playerViews removeObjectForKey:playerId];
+  [_playerRegions removeObjectForKey:playerId];
+  if (self.webView) {
+    [self evaluateHostScript:[NSString stringWithFormat:@"removePlayer('%@');", playerId]];
+  }
+}
+
+- (void)loadPlayerWithId:(NSString *)playerId
+        playerParamsJSON:(NSString *)playerParamsJSON
+        initialStateJSON:(NSString *)initialStateJSON {
+  if (![self loadPageIfNeeded]) {
+    return;
+  }
+  [_playerRegions removeObjectForKey:playerId];
+  [self evaluateHostScript:[NSString stringWithFormat:@"addPlayer('%@', %@, %@);",
+                                                      playerId,
+                                                      playerParamsJSON,
+                                                      initialStateJSON]];
+  [self updateRegionOfPlayerView:[_playerViews objectForKey:playerId]];
+}
+
+- (void)evaluateJavaScript:(NSString *)jsToExecute
+               forPlayerId:(NSString *)playerId
+         completionHandler:(void (^)(id result, NSError *error))completionHandler {
+  // Player commands are single expressions on |player|, optionally calling page functions. They
+  // are evaluated with those names bound to the hosted player and its page functions.
+  NSString *expression = [jsToExecute stringByTrimmingCharactersInSet:
+      [NSCharacterSet characterSetWithCharactersInString:@" ;\n"]];
+  NSString *script = [NSString stringWithFormat:
+      @"(function(hosted) {"
+       " if (!hosted) { return null; }"
+       " var player = hosted.player, syncClock = hosted.syncClock,"
+       " setResizesDeferred = hosted.setResizesDeferred;"
+       " return %@; })(hostedPlayer('%@'));", expression, playerId];
+  if (!_hostReady) {
+    if (completionHandler) {
+      completionHandler(nil, nil);
+    } else if (!_hostFailed) {
+      [_pendingScripts addObject:script];
+    }
+    return;
+  }
+  [self.webView evaluateJavaScript:script completionHandler:completionHandler];
+}
+
+- (void)updateRegionOfPlayerView:(YTPlayerView *)playerView {
+  NSString *playerId = playerView.playerId;
+  if (!self.webView || !playerId) {
+    return;
+  }
+  CGRect region = [playerView convertRect:playerView.bounds toView:self];
+  NSValue *regionValue = [NSValue valueWithCGRect:region];
+  if ([_playerRegions[playerId] isEqualToValue:regionValue]) {
+    return;
+  }
+  _playerRegions[playerId] = regionValue;
+  [self evaluateHostScript:[NSString stringWithFormat:@"setPlayerRegion('%@', %.1f, %.1f, %.1f, %.1f);",
+                                                      playerId,
+                                                      region.origin.x,
+                                                      region.origin.y,
+                                                      region.size.width,
+                                                      region.size.height]];
+}
+
+#pragma mark - WKNavigationDelegate
+
+- (void)webView:(WKWebView *)webView
+    decidePolicyForNavigationAction:(WKNavigationAction *)navigationAction
+                    decisionHandler:(void (^)(WKNavigationActionPolicy))decisionHandler {
+  NSURL *url = navigationAction.request.URL;
+  if ([url.scheme isEqual:@"ytplayer"]) {
+    [self handleCallbackURL:url];
+    decisionHandler(WKNavigationActionPolicyCancel);
+    return;
+  } else if ([url.scheme isEqual:@"http"] || [url.scheme isEqual:@"https"]) {
+    if ([[url.host lowercaseString] isEqualToString:[self.originURL.host lowercaseString]] ||
+        [YTPlayerView isAllowedNavigationURL:url] ||
+        ([YTPlayerView isURL:url onEmbedHostURL:self.embedHostURL] &&
+         [url.path hasPrefix:@"/embed/"])) {
+      decisionHandler(WKNavigationActionPolicyAllow);
+      return;
+    }
+    [[UIApplication sharedApplication] openURL:url
+                                       options:@{UIApplicationOpenURLOptionUniversalLinksOnly: @NO}
+                             completionHandler:nil];
+    decisionHandler(WKNavigationActionPolicyCancel);
+    return;
+  }
+  decisionHandler(WKNavigationActionPolicyAllow);
+}
+
+#pragma mark - WKScriptMessageHandler
+
+- (void)userContentController:(WKUserContentController *)userContentController
+      didReceiveScriptMessage:(WKScriptMessage *)message {
+  if (![message.body isKindOfClass:[NSString class]]) {
+    return;
+  }
+  NSURL *url = [NSURL URLWithString:message.body];
+  if ([url.scheme isEqual:@"ytplayer"]) {
+    [self handleCallbackURL:url];
+  }
+}
+
+#pragma mark - Private methods
+
+/**
+ * Private method routing an event from the shared page to the hosted player it is about, or
+ * handling it if it is about the page itself.
+ *
+ * @param url A URL of the format ytplayer://action?data=value&player=playerId.
+ */
+- (void)handleCallbackURL:(NSURL *)url {
+  NSString *action = url.host;
+  if ([action isEqual:kYTPlayerHostCallbackOnHostReady]) {
+    _hostReady = YES;
+    NSArray<NSString *> *pendingScripts = [_pendingScripts copy];
+    [_pendingScripts removeAllObjects];
+    for (NSString *script in pendingScripts) {
+      [self.webView evaluateJavaScript:script completionHandler:nil];
+    }
+    return;
+  }
+  if ([action isEqual:kYTPlayerHostCallbackOnYouTubeIframeAPIFailedToLoad]) {
+    // No player will ever run the queued commands.
+    _hostFailed = YES;
+    [_pendingScripts removeAllObjects];
+    for (YTPlayerView *playerView in _playerViews.objectEnumerator) {
+      [playerView dispatchYouTubeCallbackUrl:url];
+    }
+    return;
+  }
+  NSString *playerId = [YTPlayerView parametersForQuery:url.query][@"player"];
+  if (playerId) {
+    [[_playerViews objectForKey:playerId] dispatchYouTubeCallbackUrl:url];
+  }
+}
+
+/**
+ * Private method evaluating a script on the shared page, or queueing it until the iframe API has
+ * loaded. Scripts are dropped once the iframe API has failed to load.
+ */
+- (void)evaluateHostScript:(NSString *)script {
+  if (!_hostReady) {
+    if (!_hostFailed) {
+      [_pendingScripts addObject:script];
+    }
+    return;
+  }
+  [self.webView evaluateJavaScript:script completionHandler:nil];
+}
+
+/**
+ * Private method creating the shared web view and loading the host page into it, once.
+ *
+ * @return YES if the page is loaded or loading, NO if it could not be read.
+ */
+- (BOOL)loadPageIfNeeded {
+  if (self.webView) {
+    return YES;
+  }
+  NSString *pageTemplate = [YTPlayerView contentsOfResource:@"YTPlayerView-multiplex"
+                                                     ofType:@"html"];
+  NSString *bridgeScript = [YTPlayerView bridgeScript];
+  if (!pageTemplate || !bridgeScript) {
+    return NO;
+  }
+  NSString *bridgeScriptTag = [NSString stringWithFormat:@"<script>\n%@</script>", bridgeScript];
+  NSString *pageHTML = [NSString stringWithFormat:pageTemplate,
+                                                  bridgeScriptTag,
+                                                  [YTPlayerView embedHostOfURL:self.embedHostURL]];
+
+  YTWeakScriptMessageHandler *messageHandler = [[YTWeakScriptMessageHandler alloc] init];
+  messageHandler.handler = self;
+  WKWebViewConfiguration *webViewConfiguration = [[WKWebViewConfiguration alloc] init];
+  webViewConfiguration.allowsInlineMediaPlayback = YES;
+  webViewConfiguration.mediaTypesRequiringUserActionForPlayback = WKAudiovisualMediaTypeNone;
+  [webViewConfiguration.userContentController addScriptMessageHandler:messageHandler
+                                                                 name:kYTPlayerHostMessageHandlerName];
+
+  self.webView = [self createNewWebViewWithConfiguration:webViewConfiguration];
+  self.webView.navigationDelegate = self;
+  [self insertSubview:self.webView atIndex:0];
+  [self.webView loadHTMLString:pageHTML baseURL:self.originURL];
+  return YES;
+}
+
+- (WKWebView *)createNewWebViewWithConfiguration:(WKWebViewConfiguration *)configuration {
+  WKWebView *webView = [[WKWebView alloc] initWithFrame:self.bounds configuration:configuration];
+  webView.autoresizingMask = (UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight);
+  webView.scrollView.scrollEnabled = NO;
+  webView.scrollView.bounces = NO;
+  webView.opaque = NO;
+  webView.backgroundColor = [UIColor clearColor];
+  return webView;
+}
+
+@end
@@ -0,0 +1,57 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ * YTPlayerInitialState describes the state the player should be put in as soon as it becomes
+ * ready. It is passed at load time and applied by the player page inside its onReady handler,
+ * before -playerViewDidBecomeReady: is invoked, so no additional JavaScript evaluations are
+ * needed to configure a freshly loaded player.
+ *
+ * Every property is optional; nil properties leave the player's default untouched.
+ */
+@interface YTPlayerInitialState : NSObject <NSCopying>
+
+/** Playback rate to suggest, equivalent to YTPlayerView::setPlaybackRate:. */
+@property(nonatomic, copy, nullable) NSNumber *playbackRate;
+
+/** Whether a playlist should loop, equivalent to YTPlayerView::setLoop:. */
+@property(nonatomic, copy, nullable) NSNumber *loop;
+
+/** Whether a playlist should shuffle, equivalent to YTPlayerView::setShuffle:. */
+@property(nonatomic, copy, nullable) NSNumber *shuffle;
+
+/**
+ * 0-indexed playlist position to play, equivalent to YTPlayerView::playVideoAt:. Setting this
+ * starts playback.
+ */
+@property(nonatomic, copy, nullable) NSNumber *playlistIndex;
+
+/**
+ * Time in seconds to seek to, equivalent to YTPlayerView::seekToSeconds:allowSeekAhead: with
+ * allowSeekAhead set to YES.
+ */
+@property(nonatomic, copy, nullable) NSNumber *seekToSeconds;
+
+/** Whether playback should start once the state above has been applied. Defaults to NO. */
+@property(nonatomic) BOOL playsVideo;
+
+/**
+ * Returns the JSON-compatible dictionary handed to the player page. Only properties that have
+ * been set are included.
+ */
+- (nonnull NSDictionary *)dictionaryRepresentation;
+
+@end
@@ -0,0 +1,55 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerInitialState.h"
+
+@implementation YTPlayerInitialState
+
+- (NSDictionary *)dictionaryRepresentation {
+  NSMutableDictionary *state = [[NSMutableDictionary alloc] init];
+  if (self.playbackRate) {
+    state[@"playbackRate"] = @(self.playbackRate.floatValue);
+  }
+  if (self.loop) {
+    state[@"loop"] = @(self.loop.boolValue);
+  }
+  if (self.shuffle) {
+    state[@"shuffle"] = @(self.shuffle.boolValue);
+  }
+  if (self.playlistIndex) {
+    state[@"playlistIndex"] = @(self.playlistIndex.intValue);
+  }
+  if (self.seekToSeconds) {
+    state[@"seekToSeconds"] = @(self.seekToSeconds.floatValue);
+  }
+  if (self.playsVideo) {
+    state[@"playVideo"] = @YES;
+  }
+  return state;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+  YTPlayerInitialState *copy = [[[self class] allocWithZone:zone] init];
+  copy.playbackRate = self.playbackRate;
+  copy.loop = self.loop;
+  copy.shuffle = self.shuffle;
+  copy.playlistIndex = self.playlistIndex;
+  copy.seekToSeconds = self.seekToSeconds;
+  copy.playsVideo = self.playsVideo;
+  return copy;
+}
+
+@end
@@ -0,0 +1,124 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** These enums represent the severity of a log record, from least to most severe. */
+typedef NS_ENUM(NSInteger, YTPlayerLogLevel) {
+    kYTPlayerLogLevelDebug,
+    kYTPlayerLogLevelInfo,
+    kYTPlayerLogLevelWarning,
+    kYTPlayerLogLevelError,
+    kYTPlayerLogLevelOff
+};
+
+/**
+ * The least severe level recorded. Read by YTPlayerLog() before anything else so that disabled
+ * records cost a single comparison; set it through YTPlayerLogger::level.
+ */
+FOUNDATION_EXPORT YTPlayerLogLevel YTPlayerLogMinimumLevel;
+
+/**
+ * Logs a record at |logLevel| to the console and to |logBuffer|, which may be nil. The remaining
+ * arguments are a format string and its arguments, which are only evaluated and formatted if
+ * |logLevel| is enabled.
+ */
+#define YTPlayerLog(logLevel, logBuffer, ...)                                           \
+  do {                                                                                  \
+    if ((logLevel) >= YTPlayerLogMinimumLevel) {                                        \
+      [YTPlayerLogger logWithLevel:(logLevel) buffer:(logBuffer) format:__VA_ARGS__];  \
+    }                                                                                   \
+  } while (0)
+
+/** A log record. */
+@interface YTPlayerLogRecord : NSObject
+
+/** The system uptime when the record was logged, in seconds. */
+@property(nonatomic, readonly) NSTimeInterval timestamp;
+
+@property(nonatomic, readonly) YTPlayerLogLevel level;
+
+@property(nonatomic, readonly, nonnull) NSString *message;
+
+- (nonnull instancetype)initWithTimestamp:(NSTimeInterval)timestamp
+                                    level:(YTPlayerLogLevel)level
+                                  message:(nonnull NSString *)message;
+
+@end
+
+/**
+ * YTPlayerLogBuffer keeps the most recent log records of one player in a ring buffer, for
+ * post-mortem analysis: it can be dumped when the player reports an error, or from an app's
+ * exception handler. Each YTPlayerView has one, see YTPlayerView::logBuffer. The buffer should
+ * only be used from the main thread.
+ */
+@interface YTPlayerLogBuffer : NSObject
+
+/** The maximum number of records kept. Older records are overwritten by newer ones. */
+@property(nonatomic, readonly) NSUInteger capacity;
+
+/** The number of records kept. */
+@property(nonatomic, readonly) NSUInteger count;
+
+/** A label put before each line of YTPlayerLogBuffer::dump, e.g. a player ID. */
+@property(nonatomic, copy, nullable) NSString *label;
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/** Adds |record|, overwriting the oldest one if the buffer is full. */
+- (void)addRecord:(nonnull YTPlayerLogRecord *)record;
+
+/** Returns the records kept, oldest first. */
+- (nonnull NSArray<YTPlayerLogRecord *> *)records;
+
+/** Returns the records kept as text, one per line, oldest first. */
+- (nonnull NSString *)dump;
+
+/** Empties the buffer. */
+- (void)removeAllRecords;
+
+@end
+
+/**
+ * YTPlayerLogger writes the records of YTPlayerLog() to the unified logging system and to the
+ * log buffer of the player they concern. Its settings are process-wide.
+ */
+@interface YTPlayerLogger : NSObject
+
+/**
+ * The least severe level recorded in log buffers and considered for the console. Defaults to
+ * kYTPlayerLogLevelInfo. Set it to kYTPlayerLogLevelOff to disable logging entirely.
+ */
+@property(class, nonatomic) YTPlayerLogLevel level;
+
+/** The least severe level also written to the console. Defaults to kYTPlayerLogLevelWarning. */
+@property(class, nonatomic) YTPlayerLogLevel consoleLevel;
+
+/**
+ * Whether an error record logged to a buffer writes the whole buffer to the console, to show
+ * what led to the error. Defaults to YES.
+ */
+@property(class, nonatomic) BOOL dumpsBufferOnError;
+
+/**
+ * Logs a record. Use YTPlayerLog() instead, which skips the call and the formatting of its
+ * arguments when |level| is disabled.
+ */
++ (void)logWithLevel:(YTPlayerLogLevel)level
+              buffer:(nullable YTPlayerLogBuffer *)buffer
+              format:(nonnull NSString *)format, ... NS_FORMAT_FUNCTION(3, 4);
+
+@end
@@ -0,0 +1,196 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerLogger.h"
+
+#import <os/log.h>
+
+YTPlayerLogLevel YTPlayerLogMinimumLevel = kYTPlayerLogLevelInfo;
+
+static YTPlayerLogLevel gConsoleLevel = kYTPlayerLogLevelWarning;
+static BOOL gDumpsBufferOnError = YES;
+
+/** Returns the single-letter tag of |level| used in dumps. */
+static NSString *YTPlayerLogLevelTag(YTPlayerLogLevel level) {
+  switch (level) {
+    case kYTPlayerLogLevelDebug:
+      return @"D";
+    case kYTPlayerLogLevelInfo:
+      return @"I";
+    case kYTPlayerLogLevelWarning:
+      return @"W";
+    case kYTPlayerLogLevelError:
+    case kYTPlayerLogLevelOff:
+      return @"E";
+  }
+  return @"?";
+}
+
+@implementation YTPlayerLogRecord
+
+- (instancetype)initWithTimestamp:(NSTimeInterval)timestamp
+                            level:(YTPlayerLogLevel)level
+                          message:(NSString *)message {
+  self = [super init];
+  if (self) {
+    _timestamp = timestamp;
+    _level = level;
+    _message = [message copy];
+  }
+  return self;
+}
+
+@end
+
+@implementation YTPlayerLogBuffer {
+  // The records, in a ring of YTPlayerLogBuffer::capacity slots; |_head| is where the next
+  // record goes.
+  NSMutableArray<YTPlayerLogRecord *> *_records;
+  NSUInteger _head;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+  self = [super init];
+  if (self) {
+    _capacity = MAX(capacity, 1);
+    _records = [[NSMutableArray alloc] initWithCapacity:_capacity];
+  }
+  return self;
+}
+
+- (NSUInteger)count {
+  return _records.count;
+}
+
+- (void)addRecord:(YTPlayerLogRecord *)record {
+  if (_records.count < self.capacity) {
+    [_records addObject:record];
+  } else {
+    _records[_head] = record;
+  }
+  _head = (_head + 1) % self.capacity;
+}
+
+- (NSArray<YTPlayerLogRecord *> *)records {
+  if (_records.count < self.capacity) {
+    return [_records copy];
+  }
+  NSMutableArray<YTPlayerLogRecord *> *records =
+      [[_records subarrayWithRange:NSMakeRange(_head, _records.count - _head)] mutableCopy];
+  [records addObjectsFromArray:[_records subarrayWithRange:NSMakeRange(0, _head)]];
+  return records;
+}
+
+- (NSString *)dump {
+  NSMutableString *dump = [[NSMutableString alloc] init];
+  NSString *prefix = self.label ? [self.label stringByAppendingString:@" "] : @"";
+  for (YTPlayerLogRecord *record in [self records]) {
+    [dump appendFormat:@"%@[%10.3f] %@ %@\n",
+                       prefix, record.timestamp, YTPlayerLogLevelTag(record.level), record.message];
+  }
+  return dump;
+}
+
+- (void)removeAllRecords {
+  [_records removeAllObjects];
+  _head = 0;
+}
+
+@end
+
+@implementation YTPlayerLogger
+
++ (YTPlayerLogLevel)level {
+  return YTPlayerLogMinimumLevel;
+}
+
++ (void)setLevel:(YTPlayerLogLevel)level {
+  YTPlayerLogMinimumLevel = level;
+}
+
++ (YTPlayerLogLevel)consoleLevel {
+  return gConsoleLevel;
+}
+
++ (void)setConsoleLevel:(YTPlayerLogLevel)consoleLevel {
+  gConsoleLevel = consoleLevel;
+}
+
++ (BOOL)dumpsBufferOnError {
+  return gDumpsBufferOnError;
+}
+
++ (void)setDumpsBufferOnError:(BOOL)dumpsBufferOnError {
+  gDumpsBufferOnError = dumpsBufferOnError;
+}
+
++ (void)logWithLevel:(YTPlayerLogLevel)level
+              buffer:(YTPlayerLogBuffer *)buffer
+              format:(NSString *)format, ... {
+  if (level < YTPlayerLogMinimumLevel || level >= kYTPlayerLogLevelOff) {
+    return;
+  }
+  va_list arguments;
+  va_start(arguments, format);
+  NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+  va_end(arguments);
+
+  if (buffer) {
+    NSTimeInterval timestamp = [NSProcessInfo processInfo].systemUptime;
+    [buffer addRecord:[[YTPlayerLogRecord alloc] initWithTimestamp:timestamp
+                                                             level:level
+                                                           message:message]];
+  }
+  if (level < gConsoleLevel) {
+    return;
+  }
+  if (level == kYTPlayerLogLevelError && buffer && gDumpsBufferOnError) {
+    [self writeToConsole:[buffer dump] level:level];
+  } else {
+    NSString *label = buffer.label ? [buffer.label stringByAppendingString:@" "] : @"";
+    [self writeToConsole:[label stringByAppendingString:message] level:level];
+  }
+}
+
+#pragma mark - Private methods
+
+/**
+ * Private method writing |text| to the unified logging system with the type matching |level|.
+ */
++ (void)writeToConsole:(NSString *)text level:(YTPlayerLogLevel)level {
+  static os_log_t log;
+  static dispatch_once_t predicate;
+  dispatch_once(&predicate, ^{
+    log = os_log_create("com.google.youtube-ios-player-helper", "YTPlayer");
+  });
+  os_log_type_t type = OS_LOG_TYPE_DEFAULT;
+  switch (level) {
+    case kYTPlayerLogLevelDebug:
+      type = OS_LOG_TYPE_DEBUG;
+      break;
+    case kYTPlayerLogLevelInfo:
+      type = OS_LOG_TYPE_INFO;
+      break;
+    case kYTPlayerLogLevelWarning:
+    case kYTPlayerLogLevelOff:
+      type = OS_LOG_TYPE_DEFAULT;
+      break;
+    case kYTPlayerLogLevelError:
+      type = OS_LOG_TYPE_ERROR;
+      break;
+  }
+  os_log_with_type(log, type, "%{public}@", text);
+}
+
+@end
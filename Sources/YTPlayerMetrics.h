@@ -0,0 +1,64 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** The bridge health of a player at one point in time, see YTPlayerMetrics. */
+typedef struct {
+    double eventsPerSecond;               // Events received from the page in the last second.
+    NSUInteger pendingCommandCount;       // Evaluations sent to the page and not completed yet.
+    NSTimeInterval lastGetterRoundTrip;   // Of the latest getter, or NAN before any completed.
+    NSTimeInterval timeSinceLastPlayTime; // Since the latest onPlayTime, or NAN before any.
+    NSInteger playerState;                // The latest reported YTPlayerState.
+    double bufferedAheadSeconds;          // Seconds of video buffered ahead of the playhead.
+} YTPlayerMetricsSnapshot;
+
+/**
+ * YTPlayerMetrics aggregates counters describing the health of the bridge between a YTPlayerView
+ * and its page. Recording only updates a few fields, so the counters can be kept up to date at
+ * all times; the aggregates are computed when a snapshot is taken, e.g. by the metrics HUD of
+ * YTPlayerView while it is shown.
+ *
+ * Times are in seconds on a monotonic clock such as CACurrentMediaTime().
+ */
+@interface YTPlayerMetrics : NSObject
+
+/** The latest reported YTPlayerState. Defaults to kYTPlayerStateUnknown. */
+@property(nonatomic) NSInteger playerState;
+
+/** Seconds of video buffered ahead of the playhead as of the latest report. */
+@property(nonatomic) double bufferedAheadSeconds;
+
+/** Records an event received from the page at |time|. */
+- (void)recordEventAtTime:(NSTimeInterval)time;
+
+/** Records an onPlayTime report received at |time|. */
+- (void)recordPlayTimeAtTime:(NSTimeInterval)time;
+
+/** Records that a script was sent to the page for evaluation. */
+- (void)recordCommandSent;
+
+/** Records that the evaluation of a script sent earlier completed. */
+- (void)recordCommandCompleted;
+
+/** Records the time between sending a getter and receiving its result. */
+- (void)recordGetterRoundTrip:(NSTimeInterval)roundTrip;
+
+/** Returns the aggregated counters as of |time|. */
+- (YTPlayerMetricsSnapshot)snapshotAtTime:(NSTimeInterval)time;
+
+/** Forgets everything recorded so far, e.g. when a new player is loaded. */
+- (void)reset;
+
+@end
@@ -0,0 +1,105 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerMetrics.h"
+
+// kYTPlayerStateUnknown, kept here so the metrics do not depend on UIKit.
+static const NSInteger kYTPlayerMetricsUnknownState = 6;
+
+@implementation YTPlayerMetrics {
+  // Events are counted in whole-second buckets. The rate is the count of the last full bucket.
+  NSTimeInterval _bucketStart;
+  NSUInteger _bucketEventCount;
+  NSUInteger _previousBucketEventCount;
+  NSUInteger _pendingCommandCount;
+  NSTimeInterval _lastGetterRoundTrip;
+  NSTimeInterval _lastPlayTimeReportTime;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    [self reset];
+  }
+  return self;
+}
+
+- (void)recordEventAtTime:(NSTimeInterval)time {
+  [self advanceBucketToTime:time];
+  _bucketEventCount++;
+}
+
+- (void)recordPlayTimeAtTime:(NSTimeInterval)time {
+  _lastPlayTimeReportTime = time;
+}
+
+- (void)recordCommandSent {
+  _pendingCommandCount++;
+}
+
+- (void)recordCommandCompleted {
+  if (_pendingCommandCount > 0) {
+    _pendingCommandCount--;
+  }
+}
+
+- (void)recordGetterRoundTrip:(NSTimeInterval)roundTrip {
+  _lastGetterRoundTrip = roundTrip;
+}
+
+- (YTPlayerMetricsSnapshot)snapshotAtTime:(NSTimeInterval)time {
+  [self advanceBucketToTime:time];
+  YTPlayerMetricsSnapshot snapshot;
+  snapshot.eventsPerSecond = _previousBucketEventCount;
+  snapshot.pendingCommandCount = _pendingCommandCount;
+  snapshot.lastGetterRoundTrip = _lastGetterRoundTrip;
+  snapshot.timeSinceLastPlayTime =
+      isnan(_lastPlayTimeReportTime) ? NAN : time - _lastPlayTimeReportTime;
+  snapshot.playerState = self.playerState;
+  snapshot.bufferedAheadSeconds = self.bufferedAheadSeconds;
+  return snapshot;
+}
+
+- (void)reset {
+  _bucketStart = NAN;
+  _bucketEventCount = 0;
+  _previousBucketEventCount = 0;
+  _pendingCommandCount = 0;
+  _lastGetterRoundTrip = NAN;
+  _lastPlayTimeReportTime = NAN;
+  _playerState = kYTPlayerMetricsUnknownState;
+  _bufferedAheadSeconds = 0;
+}
+
+#pragma mark - Private methods
+
+/**
+ * Private method that starts a new bucket if |time| is past the current one. The previous count
+ * only carries over if the buckets are adjacent; otherwise a second without events has passed.
+ */
+- (void)advanceBucketToTime:(NSTimeInterval)time {
+  if (isnan(_bucketStart)) {
+    _bucketStart = floor(time);
+    return;
+  }
+  NSTimeInterval elapsed = time - _bucketStart;
+  if (elapsed < 1) {
+    return;
+  }
+  _previousBucketEventCount = elapsed < 2 ? _bucketEventCount : 0;
+  _bucketEventCount = 0;
+  _bucketStart = floor(time);
+}
+
+@end
@@ -0,0 +1,32 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <UIKit/UIKit.h>
+
+#import "YTPlayerMetrics.h"
+
+/**
+ * YTPlayerMetricsHUDView is a small translucent overlay showing a YTPlayerMetricsSnapshot. It is
+ * managed by YTPlayerView when YTPlayerView::showsMetricsHUD is set, and ignores touches so the
+ * player underneath stays usable.
+ */
+@interface YTPlayerMetricsHUDView : UIView
+
+/** Displays |snapshot|, resizing the view to fit. */
+- (void)showSnapshot:(YTPlayerMetricsSnapshot)snapshot;
+
+/** Returns the text displayed for |snapshot|, one metric per line. */
++ (nonnull NSString *)textForSnapshot:(YTPlayerMetricsSnapshot)snapshot;
+
+@end
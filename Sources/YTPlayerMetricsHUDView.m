@@ -0,0 +1,94 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerMetricsHUDView.h"
+
+#import "YTPlayerView.h"
+
+// Padding between the edges of the HUD and its text.
+static const CGFloat kYTPlayerMetricsHUDPadding = 4;
+
+@implementation YTPlayerMetricsHUDView {
+  UILabel *_label;
+}
+
+- (instancetype)initWithFrame:(CGRect)frame {
+  self = [super initWithFrame:frame];
+  if (self) {
+    self.userInteractionEnabled = NO;
+    self.backgroundColor = [UIColor colorWithWhite:0 alpha:0.6];
+    self.layer.cornerRadius = 4;
+    _label = [[UILabel alloc] init];
+    _label.numberOfLines = 0;
+    _label.textColor = [UIColor greenColor];
+    _label.font = [UIFont fontWithName:@"Menlo" size:10] ?: [UIFont systemFontOfSize:10];
+    [self addSubview:_label];
+  }
+  return self;
+}
+
+- (void)showSnapshot:(YTPlayerMetricsSnapshot)snapshot {
+  _label.text = [YTPlayerMetricsHUDView textForSnapshot:snapshot];
+  [_label sizeToFit];
+  _label.frame = CGRectOffset(_label.bounds, kYTPlayerMetricsHUDPadding, kYTPlayerMetricsHUDPadding);
+  CGRect frame = self.frame;
+  frame.size = CGSizeMake(CGRectGetWidth(_label.bounds) + 2 * kYTPlayerMetricsHUDPadding,
+                          CGRectGetHeight(_label.bounds) + 2 * kYTPlayerMetricsHUDPadding);
+  self.frame = frame;
+}
+
++ (NSString *)textForSnapshot:(YTPlayerMetricsSnapshot)snapshot {
+  return [NSString stringWithFormat:@"events/s  %.0f\n"
+                                     "pending   %lu\n"
+                                     "getter    %@\n"
+                                     "playTime  %@\n"
+                                     "state     %@\n"
+                                     "buffered  %.1f s",
+                                    snapshot.eventsPerSecond,
+                                    (unsigned long)snapshot.pendingCommandCount,
+                                    [self stringForMilliseconds:snapshot.lastGetterRoundTrip],
+                                    [self stringForMilliseconds:snapshot.timeSinceLastPlayTime],
+                                    [self stringForPlayerState:snapshot.playerState],
+                                    snapshot.bufferedAheadSeconds];
+}
+
+#pragma mark - Private methods
+
++ (NSString *)stringForMilliseconds:(NSTimeInterval)seconds {
+  if (isnan(seconds)) {
+    return @"-";
+  }
+  return [NSString stringWithFormat:@"%.0f ms", seconds * 1000];
+}
+
++ (NSString *)stringForPlayerState:(NSInteger)state {
+  switch (state) {
+    case kYTPlayerStateUnstarted:
+      return @"unstarted";
+    case kYTPlayerStateEnded:
+      return @"ended";
+    case kYTPlayerStatePlaying:
+      return @"playing";
+    case kYTPlayerStatePaused:
+      return @"paused";
+    case kYTPlayerStateBuffering:
+      return @"buffering";
+    case kYTPlayerStateCued:
+      return @"cued";
+    default:
+      return @"unknown";
+  }
+}
+
+@end
@@ -0,0 +1,95 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import <WebKit/WebKit.h>
+
+/** The URL scheme the player page is served under by YTPlayerPageSchemeHandler. */
+extern NSString *_Nonnull const kYTPlayerPageURLScheme;
+
+/** An HTTP response built by YTPlayerPageServer. */
+@interface YTPlayerPageResponse : NSObject
+
+/** The HTTP status code: 200, 404 or 405. */
+@property(nonatomic, readonly) NSInteger statusCode;
+
+/** The HTTP header fields, e.g. Content-Type and Content-Length. */
+@property(nonatomic, readonly, nonnull) NSDictionary<NSString *, NSString *> *headerFields;
+
+/** The response body, empty unless the status code is 200 and the method GET. */
+@property(nonatomic, readonly, nonnull) NSData *body;
+
+@end
+
+/**
+ * YTPlayerPageServer answers requests for the player page and its bridge script from memory.
+ *
+ * WebKit neither caches the responses of a WKURLSchemeHandler nor sends it conditional requests,
+ * so every load requests both again. The server keeps both encoded, the bridge script once for
+ * the lifetime of the server and the page whenever it is set, so that answering a request never
+ * reads or encodes anything. A YTPlayerView keeps its server across loads.
+ *
+ * The server only builds responses; YTPlayerPageSchemeHandler hands them to WebKit.
+ */
+@interface YTPlayerPageServer : NSObject
+
+/**
+ * Initializes a server for |bridgeScript|.
+ *
+ * @param bridgeScript The JavaScript source of the bridge script.
+ * @return An initialized server.
+ */
+- (nonnull instancetype)initWithBridgeScript:(nonnull NSString *)bridgeScript
+    NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/** The page HTML served at YTPlayerPageServer::pagePath, or nil to answer 404. */
+@property(nonatomic, copy, nullable) NSString *pageHTML;
+
+/** The path the page is served at. */
+@property(nonatomic, readonly, nonnull) NSString *pagePath;
+
+/** The path the bridge script is served at. */
+@property(nonatomic, readonly, nonnull) NSString *bridgeScriptPath;
+
+/**
+ * Builds the response to |request|.
+ *
+ * @param request A request for a URL of any host under kYTPlayerPageURLScheme.
+ * @return The response.
+ */
+- (nonnull YTPlayerPageResponse *)responseForRequest:(nonnull NSURLRequest *)request;
+
+@end
+
+/**
+ * A WKURLSchemeHandler serving the responses of a YTPlayerPageServer, so that the player page is
+ * loaded from memory instead of through -[WKWebView loadHTMLString:baseURL:].
+ */
+API_AVAILABLE(ios(11.0))
+@interface YTPlayerPageSchemeHandler : NSObject <WKURLSchemeHandler>
+
+/**
+ * Initializes a handler for |server|.
+ *
+ * @param server The server building the responses. It is retained.
+ * @return An initialized handler.
+ */
+- (nonnull instancetype)initWithServer:(nonnull YTPlayerPageServer *)server
+    NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
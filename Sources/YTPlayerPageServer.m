@@ -0,0 +1,128 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTPlayerPageServer.h"
+
+NSString *const kYTPlayerPageURLScheme = @"ytplayer-page";
+
+NSString static *const kYTPlayerPagePath = @"/player.html";
+NSString static *const kYTPlayerPageBridgeScriptPath = @"/bridge.js";
+
+@interface YTPlayerPageResponse ()
+
+@property(nonatomic) NSInteger statusCode;
+@property(nonatomic) NSDictionary<NSString *, NSString *> *headerFields;
+@property(nonatomic) NSData *body;
+
+@end
+
+@implementation YTPlayerPageResponse
+@end
+
+@implementation YTPlayerPageServer {
+  NSData *_bridgeScriptData;
+  NSData *_pageData;
+}
+
+- (instancetype)initWithBridgeScript:(NSString *)bridgeScript {
+  self = [super init];
+  if (self) {
+    _bridgeScriptData = [bridgeScript dataUsingEncoding:NSUTF8StringEncoding];
+    _bridgeScriptPath = kYTPlayerPageBridgeScriptPath;
+    _pagePath = kYTPlayerPagePath;
+  }
+  return self;
+}
+
+- (void)setPageHTML:(NSString *)pageHTML {
+  _pageHTML = [pageHTML copy];
+  _pageData = [_pageHTML dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (YTPlayerPageResponse *)responseForRequest:(NSURLRequest *)request {
+  NSString *method = request.HTTPMethod ?: @"GET";
+  if (![method isEqualToString:@"GET"] && ![method isEqualToString:@"HEAD"]) {
+    return [self responseWithStatusCode:405 headerFields:@{ @"Allow" : @"GET, HEAD" } body:nil];
+  }
+
+  NSString *path = request.URL.path;
+  NSData *body = nil;
+  NSString *contentType = nil;
+  if ([path isEqualToString:self.bridgeScriptPath]) {
+    body = _bridgeScriptData;
+    contentType = @"text/javascript; charset=utf-8";
+  } else if ([path isEqualToString:self.pagePath] && _pageData) {
+    body = _pageData;
+    contentType = @"text/html; charset=utf-8";
+  } else {
+    return [self responseWithStatusCode:404 headerFields:@{} body:nil];
+  }
+
+  NSDictionary<NSString *, NSString *> *headerFields = @{
+    @"Content-Type" : contentType,
+    @"Content-Length" : [NSString stringWithFormat:@"%lu", (unsigned long)body.length]
+  };
+  return [self responseWithStatusCode:200
+                         headerFields:headerFields
+                                 body:[method isEqualToString:@"HEAD"] ? nil : body];
+}
+
+#pragma mark - Private methods
+
+- (YTPlayerPageResponse *)responseWithStatusCode:(NSInteger)statusCode
+                                    headerFields:(NSDictionary<NSString *, NSString *> *)headerFields
+                                            body:(NSData *)body {
+  YTPlayerPageResponse *response = [[YTPlayerPageResponse alloc] init];
+  response.statusCode = statusCode;
+  response.headerFields = headerFields;
+  response.body = body ?: [NSData data];
+  return response;
+}
+
+@end
+
+@implementation YTPlayerPageSchemeHandler {
+  YTPlayerPageServer *_server;
+}
+
+- (instancetype)initWithServer:(YTPlayerPageServer *)server {
+  self = [super init];
+  if (self) {
+    _server = server;
+  }
+  return self;
+}
+
+#pragma mark - WKURLSchemeHandler
+
+- (void)webView:(WKWebView *)webView startURLSchemeTask:(id<WKURLSchemeTask>)urlSchemeTask {
+  YTPlayerPageResponse *response = [_server responseForRequest:urlSchemeTask.request];
+  NSHTTPURLResponse *urlResponse =
+      [[NSHTTPURLResponse alloc] initWithURL:urlSchemeTask.request.URL
+                                  statusCode:response.statusCode
+                                 HTTPVersion:@"HTTP/1.1"
+                                headerFields:response.headerFields];
+  [urlSchemeTask didReceiveResponse:urlResponse];
+  if (response.body.length) {
+    [urlSchemeTask didReceiveData:response.body];
+  }
+  [urlSchemeTask didFinish];
+}
+
+- (void)webView:(WKWebView *)webView stopURLSchemeTask:(id<WKURLSchemeTask>)urlSchemeTask {
+  // Responses are delivered synchronously in -webView:startURLSchemeTask:, so there is never a
+  // task in flight to stop.
+}
+
+@end
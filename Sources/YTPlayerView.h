@@ -15,6 +15,23 @@
 #import <UIKit/UIKit.h>
 #import <WebKit/WebKit.h>
 
+#import "YTBridgeEventScheduler.h"
+#import "YTBridgeLatencyEstimator.h"
+#import "YTBufferEstimator.h"
+#import "YTCommandEffectTracker.h"
+#import "YTPlayerCircuitBreaker.h"
+#import "YTPlayerCommandEncoder.h"
+#import "YTPlayerConfiguration.h"
+#import "YTPlayerInitialState.h"
+#import "YTPlayerLogger.h"
+#import "YTPlayerMetrics.h"
+#import "YTPlayerPageServer.h"
+#import "YTPlayQueue.h"
+#import "YTSpeculativeLoadTracker.h"
+#import "YTWatchedRanges.h"
+
+@class YTPlayerHostView;
+
 @class YTPlayerView;
 
 /** These enums represent the state of the current video in the player. */
@@ -41,6 +58,16 @@ typedef NS_ENUM(NSInteger, YTPlaybackQuality) {
     kYTPlaybackQualityUnknown /** This should never be returned. It is here for future proofing. */
 };
 
+/** Error domain for errors loading the player, see YTPlayerViewError. */
+FOUNDATION_EXPORT NSString *_Nonnull const YTPlayerViewErrorDomain;
+
+/** These enums represent the reasons the player could not be loaded. */
+typedef NS_ENUM(NSInteger, YTPlayerViewError) {
+    kYTPlayerViewErrorIframeAPIFailedToLoad, // The iframe API script could not be loaded.
+    kYTPlayerViewErrorIframeAPIUnavailable   // The load was not attempted because recent ones
+                                             // failed, see YTPlayerView::circuitBreaker.
+};
+
 /** These enums represent error codes thrown by the player. */
 typedef NS_ENUM(NSInteger, YTPlayerError) {
     kYTPlayerErrorInvalidParam,
@@ -52,6 +79,14 @@ typedef NS_ENUM(NSInteger, YTPlayerError) {
     kYTPlayerErrorUnknown
 };
 
+/** The camera orientation of a 360° video, in degrees. */
+typedef struct {
+    float yaw;         // 0 to 360, clockwise from the center of the video.
+    float pitch;       // -90 to 90, up and down.
+    float roll;        // -180 to 180, clockwise and counterclockwise rotation.
+    float fieldOfView; // 30 to 120, the horizontal field of view.
+} YTSphericalProperties;
+
 /** Completion handlers for player API calls. */
 typedef void (^YTIntCompletionHandler)(int result, NSError *_Nullable error);
 typedef void (^YTFloatCompletionHandler)(float result, NSError *_Nullable error);
@@ -112,6 +147,55 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)playerView:(nonnull YTPlayerView *)playerView didPlayTime:(float)playTime;
 
+/**
+ * Callback invoked when the playback rate has changed, whether through
+ * YTPlayerView::setPlaybackRate: or the player controls.
+ *
+ * @param playerView The YTPlayerView instance where the playback rate has changed.
+ * @param playbackRate The new playback rate, e.g. 1 for normal speed.
+ */
+- (void)playerView:(nonnull YTPlayerView *)playerView didChangeToPlaybackRate:(float)playbackRate;
+
+/**
+ * Callback invoked when the player has loaded or unloaded a module with its own API, such as
+ * captions.
+ *
+ * @param playerView The YTPlayerView instance whose modules have changed.
+ * @param modules The names of the modules now loaded, possibly empty.
+ */
+- (void)playerView:(nonnull YTPlayerView *)playerView
+    didChangeAPIModules:(nonnull NSArray<NSString *> *)modules;
+
+/**
+ * Callback invoked when the web view has blocked playback that was not started by the user,
+ * e.g. YTPlayerView::playVideo called without a user gesture. Show a play button instead.
+ * Only invoked by versions of the IFrame API that report it.
+ *
+ * @param playerView The YTPlayerView instance whose playback was blocked.
+ */
+- (void)playerViewAutoplayWasBlocked:(nonnull YTPlayerView *)playerView;
+
+/**
+ * Callback invoked when the player could not be loaded because the YouTube iframe API is not
+ * reachable. No further callbacks are invoked for this load.
+ *
+ * @param playerView The YTPlayerView instance that failed to load.
+ * @param error An error in YTPlayerViewErrorDomain. kYTPlayerViewErrorIframeAPIUnavailable means
+ *              the load failed fast without a network request.
+ */
+- (void)playerView:(nonnull YTPlayerView *)playerView
+    didFailToLoadIframeAPIWithError:(nonnull NSError *)error;
+
+/**
+ * Callback invoked when the buffer is predicted to run out soon, before playback actually
+ * stalls. It is invoked once each time the prediction starts; see
+ * YTPlayerView::bufferEstimator for the underlying measurements.
+ *
+ * @param playerView The YTPlayerView instance that is about to stall.
+ * @param seconds The estimated number of seconds until playback stalls.
+ */
+- (void)playerView:(nonnull YTPlayerView *)playerView predictsRebufferInSeconds:(double)seconds;
+
 /**
  * Callback invoked when setting up the webview to allow custom colours so it fits in
  * with app color schemes. If a transparent view is required specify clearColor and
@@ -159,6 +243,21 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
 
 - (nonnull instancetype)initWithOriginURL:(nonnull NSURL*)originURL;
 
+/**
+ * Initializes a player hosted by |hostView|, which renders it in its shared web view instead of
+ * this view creating its own. See YTPlayerHostView. The player uses the host's origin URL.
+ *
+ * @param hostView The host view. It is held weakly; keep it alive as long as the player.
+ * @return An initialized player view.
+ */
+- (nonnull instancetype)initWithHostView:(nonnull YTPlayerHostView *)hostView;
+
+/** The host view this player is rendered by, or nil for a standalone player. */
+@property(nonatomic, weak, readonly, nullable) YTPlayerHostView *hostView;
+
+/** The ID of this player on the page of YTPlayerView::hostView, or nil for a standalone player. */
+@property(nonatomic, copy, readonly, nullable) NSString *playerId;
+
 /**
  * This method loads the player with the given video ID.
  * This is a convenience method for calling YTPlayerView::loadPlayerWithVideoId:withPlayerVars:
@@ -236,6 +335,51 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
 - (BOOL)loadWithPlaylistId:(nonnull NSString *)playlistId
                 playerVars:(nullable NSDictionary *)playerVars;
 
+/**
+ * This method loads the player with the given video ID and player variables, and puts the player
+ * in |initialState| as soon as it is ready. The initial state is applied by the player page
+ * before YTPlayerViewDelegate::playerViewDidBecomeReady: is invoked, which saves the separate
+ * JavaScript evaluations that calling YTPlayerView::setPlaybackRate:, YTPlayerView::setLoop:,
+ * YTPlayerView::seekToSeconds:allowSeekAhead: etc. from that callback would cost.
+ *
+ * @param videoId The YouTube video ID of the video to load in the player view.
+ * @param playerVars An NSDictionary of player parameters.
+ * @param initialState The state to apply once the player is ready, or nil.
+ * @return YES if player has been configured correctly, NO otherwise.
+ */
+- (BOOL)loadWithVideoId:(nonnull NSString *)videoId
+             playerVars:(nullable NSDictionary *)playerVars
+           initialState:(nullable YTPlayerInitialState *)initialState;
+
+/**
+ * This method loads the player with the given playlist ID and player variables, and puts the
+ * player in |initialState| as soon as it is ready. See
+ * YTPlayerView::loadWithVideoId:playerVars:initialState: for details.
+ *
+ * @param playlistId The YouTube playlist ID of the playlist to load in the player view.
+ * @param playerVars An NSDictionary of player parameters.
+ * @param initialState The state to apply once the player is ready, or nil.
+ * @return YES if player has been configured correctly, NO otherwise.
+ */
+- (BOOL)loadWithPlaylistId:(nonnull NSString *)playlistId
+                playerVars:(nullable NSDictionary *)playerVars
+              initialState:(nullable YTPlayerInitialState *)initialState;
+
+/**
+ * This method loads the player with the given video ID and a prebuilt configuration. Unlike
+ * YTPlayerView::loadWithVideoId:playerVars:, the player parameters are not validated or
+ * serialized again on every load, so a single configuration should be built once with
+ * YTPlayerConfigurationBuilder and reused for every video loaded with the same parameters.
+ *
+ * This method reloads the entire contents of the webview and regenerates its HTML contents.
+ *
+ * @param videoId The YouTube video ID of the video to load in the player view.
+ * @param configuration A validated player configuration.
+ * @return YES if player has been configured correctly, NO otherwise.
+ */
+- (BOOL)loadWithVideoId:(nonnull NSString *)videoId
+          configuration:(nonnull YTPlayerConfiguration *)configuration;
+
 /**
  * This method loads an iframe player with the given player parameters. Usually you may want to use
  * -loadWithVideoId:playerVars: or -loadWithPlaylistId:playerVars: instead of this method does not handle
@@ -249,6 +393,98 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (BOOL)loadWithPlayerParams:(nullable NSDictionary *)additionalPlayerParams;
 
+/**
+ * Whether players loaded from now on are served from memory by a YTPlayerPageSchemeHandler
+ * instead of being injected with -[WKWebView loadHTMLString:baseURL:]. The page then loads the
+ * bridge script from the same in-memory server instead of carrying it inline, the server is kept
+ * across loads, and the web views of all players served from memory share one WKProcessPool.
+ * WebKit does not cache the responses of a scheme handler, so each load requests both again.
+ *
+ * The page's origin, which is also passed to the player as its origin, becomes
+ * kYTPlayerPageURLScheme followed by the host of the origin URL. The embed must accept that
+ * origin for its messages to reach the page; check that players still become ready, e.g. with
+ * YTPlayerViewDelegate::playerViewDidBecomeReady:, before enabling this in a release. Requires
+ * iOS 11; ignored on earlier versions. Defaults to NO.
+ */
+@property(nonatomic) BOOL servesPageFromMemory;
+
+/**
+ * The host the iframe API script and the embed are loaded from, e.g. a local stand-in for the
+ * YouTube endpoints in test builds. Navigations to its /embed/ path are allowed in the web view
+ * like those to the YouTube embed. Plain http hosts need an App Transport Security exception.
+ * Takes effect at the next load. Defaults to https://www.youtube.com; set it to nil to reset.
+ * Hosted players use YTPlayerHostView::embedHostURL of their host instead.
+ */
+@property(nonatomic, null_resettable) NSURL *embedHostURL;
+
+/**
+ * The circuit breaker consulted before loading the iframe API, and told whether it loaded. While
+ * it is open, loads return NO and report kYTPlayerViewErrorIframeAPIUnavailable to the delegate
+ * without creating a web view. Players in a YTPlayerHostView do not use it. Defaults to
+ * YTPlayerCircuitBreaker::sharedBreaker; set it to nil to reset.
+ */
+@property(nonatomic, null_resettable) YTPlayerCircuitBreaker *circuitBreaker;
+
+#pragma mark - Speculative loading
+
+/**
+ * Starts loading the player with a video cued, on a sign that the user is about to watch it,
+ * e.g. a touch down or hover on a feed item. Follow up with
+ * YTPlayerView::commitPreparedLoad when the gesture turns out to be a tap, or
+ * YTPlayerView::cancelPreparedLoad when it becomes a scroll. Preparing the video already being
+ * prepared does nothing; preparing another one cancels the earlier one.
+ *
+ * @param videoId The YouTube video ID of the video to prepare.
+ * @param playerVars An NSDictionary of player parameters, as for
+ *                   YTPlayerView::loadWithVideoId:playerVars:.
+ * @return YES if the player is loading or has loaded the video.
+ */
+- (BOOL)prepareToLoadWithVideoId:(nonnull NSString *)videoId
+                      playerVars:(nullable NSDictionary *)playerVars;
+
+/**
+ * Plays the prepared video, as soon as the player is ready if it is not yet.
+ *
+ * @return NO if no load was being prepared, in which case the video should be loaded normally.
+ */
+- (BOOL)commitPreparedLoad;
+
+/**
+ * Cancels the prepared load and tears down its web view. Does nothing if no load is being
+ * prepared.
+ */
+- (void)cancelPreparedLoad;
+
+/** Whether a load was prepared and neither committed nor cancelled yet. */
+@property(nonatomic, readonly, getter=isPreparingLoad) BOOL preparingLoad;
+
+/**
+ * Where speculative loads are reported. Defaults to YTSpeculativeLoadTracker::sharedTracker; set
+ * it to nil to reset.
+ */
+@property(nonatomic, null_resettable) YTSpeculativeLoadTracker *speculativeLoadTracker;
+
+#pragma mark - Command protocol
+
+/**
+ * Whether fire-and-forget player commands, such as YTPlayerView::playVideo or
+ * YTPlayerView::seekToSeconds:allowSeekAhead:, are sent to the page as opcodes encoded by
+ * YTPlayerCommandEncoder instead of as generated JavaScript source. On iOS 14 and later the
+ * encoded commands are passed as an argument to a script that never changes, so WebKit can reuse
+ * its compiled form. Commands returning a value are unaffected. Ignored for players in a
+ * YTPlayerHostView. Defaults to NO.
+ */
+@property(nonatomic) BOOL usesCommandProtocol;
+
+/**
+ * Sends all player commands issued by |commands| to the page in one batch, in order, instead of
+ * one script evaluation each. Only takes effect when YTPlayerView::usesCommandProtocol is YES.
+ * Calls may be nested; the batch is sent when the outermost call returns.
+ *
+ * @param commands A block calling player command methods on this player.
+ */
+- (void)performCommandBatch:(nonnull void (NS_NOESCAPE ^)(void))commands;
+
 #pragma mark - Player controls
 
 // These methods correspond to their JavaScript equivalents as documented here:
@@ -261,6 +497,16 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)playVideo;
 
+/**
+ * Starts or resumes playback, like YTPlayerView::playVideo, and calls |completionHandler| once
+ * the player page reports that the video is playing, or after
+ * YTPlayerView::commandEffectTracker times out. If the video is already playing, it is called
+ * right away.
+ *
+ * @param completionHandler Called on the main thread once the command ended, or nil.
+ */
+- (void)playVideoWithCompletionHandler:(nullable YTCommandEffectHandler)completionHandler;
+
 /**
  * Pauses playback on a playing video. Corresponds to this method from
  * the JavaScript API:
@@ -268,6 +514,15 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)pauseVideo;
 
+/**
+ * Pauses playback, like YTPlayerView::pauseVideo, and calls |completionHandler| once the player
+ * page reports that the video is paused, or after YTPlayerView::commandEffectTracker times out.
+ * The paused state YTPlayerView::pauseVideo reports to the delegate right away does not count.
+ *
+ * @param completionHandler Called on the main thread once the command ended, or nil.
+ */
+- (void)pauseVideoWithCompletionHandler:(nullable YTCommandEffectHandler)completionHandler;
+
 /**
  * Stops playback on a playing video. Corresponds to this method from
  * the JavaScript API:
@@ -286,6 +541,21 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)seekToSeconds:(float)seekToSeconds allowSeekAhead:(BOOL)allowSeekAhead;
 
+/**
+ * Seeks, like YTPlayerView::seekToSeconds:allowSeekAhead:, and calls |completionHandler| once
+ * the player page reports a play time within YTCommandEffectTracker::seekTolerance of the
+ * target. The page only reports play times while playing, every half second, so a seek made
+ * while paused is only observed once playback resumes.
+ *
+ * @param seekToSeconds The time in seconds to seek to in the loaded video.
+ * @param allowSeekAhead Whether to make a new request to the server if the time is
+ *                       outside what is currently buffered.
+ * @param completionHandler Called on the main thread once the command ended, or nil.
+ */
+- (void)seekToSeconds:(float)seekToSeconds
+       allowSeekAhead:(BOOL)allowSeekAhead
+    completionHandler:(nullable YTCommandEffectHandler)completionHandler;
+
 #pragma mark - Cueing videos
 
 // Cueing functions for videos. These methods correspond to their JavaScript
@@ -304,6 +574,18 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
 - (void)cueVideoById:(nonnull NSString *)videoId
         startSeconds:(float)startSeconds;
 
+/**
+ * Cues a video, like YTPlayerView::cueVideoById:startSeconds:, and calls |completionHandler|
+ * once the player page reports that the video is cued.
+ *
+ * @param videoId A video ID to cue.
+ * @param startSeconds Time in seconds to start the video when YTPlayerView::playVideo is called.
+ * @param completionHandler Called on the main thread once the command ended, or nil.
+ */
+- (void)cueVideoById:(nonnull NSString *)videoId
+         startSeconds:(float)startSeconds
+    completionHandler:(nullable YTCommandEffectHandler)completionHandler;
+
 /**
  * Cues a given video by its video ID for playback starting and ending at the given times.
  * Cueing loads a video, but does not start video playback. This
@@ -488,6 +770,30 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)playVideoAt:(int)index;
 
+#pragma mark - Play queue
+
+/**
+ * A native queue of videos to play one after the other. When set, the player loads
+ * YTPlayQueue::upNextItem with YTPlayerView::loadVideoById:startSeconds:endSeconds: whenever the
+ * current video ends. The queue can be edited at any time without affecting the playing video,
+ * and the full list is never sent to the player.
+ */
+@property(nonatomic, strong, nullable) YTPlayQueue *playQueue;
+
+/**
+ * Makes |item| the current item of YTPlayerView::playQueue and loads it.
+ *
+ * @param item An item of YTPlayerView::playQueue.
+ */
+- (void)playQueueItem:(nonnull YTPlayQueueItem *)item;
+
+/**
+ * Skips to YTPlayQueue::upNextItem of YTPlayerView::playQueue and loads it.
+ *
+ * @return YES if an item was loaded, NO if the end of the queue has been reached.
+ */
+- (BOOL)advancePlayQueue;
+
 #pragma mark - Setting the playback rate
 
 /**
@@ -548,6 +854,37 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
 - (void)setShuffle:(BOOL)shuffle;
 
 #pragma mark - Playback status
+
+/**
+ * Tracks how much of the current video is buffered ahead of the playhead and how fast the buffer
+ * fills, from samples the player page pushes while a video is playing. Reading it does not
+ * evaluate any JavaScript.
+ */
+@property(nonatomic, readonly, nonnull) YTBufferEstimator *bufferEstimator;
+
+/**
+ * The parts of the current video watched so far, built from the play time the player page
+ * reports while a video is playing. Seeked-over parts are not counted. It is reset when a new
+ * video starts.
+ */
+@property(nonatomic, readonly, nonnull) YTWatchedRanges *watchedRanges;
+
+/**
+ * The player state most recently reported by the player page, or kYTPlayerStateUnstarted before
+ * the first report. Unlike YTPlayerView::playerState:, reading it does not evaluate any
+ * JavaScript.
+ */
+@property(nonatomic, readonly) YTPlayerState lastReportedState;
+
+/**
+ * Matches play, pause, seek and cue commands against what the player page reports to find out
+ * when they took effect, and keeps their effect latencies since the player was created. Commands
+ * are tracked whether or not they were sent with a completion handler; pending ones are
+ * cancelled when a player is loaded or the web view removed. Set its timeout to change how long
+ * commands may take.
+ */
+@property(nonatomic, readonly, nonnull) YTCommandEffectTracker *commandEffectTracker;
+
 // These methods correspond to the JavaScript methods defined here:
 //    https://developers.google.com/youtube/js_api_reference#Playback_status
 
@@ -641,6 +978,113 @@ typedef void (^YTPlaybackQualityCompletionHandler)(YTPlaybackQuality result,
  */
 - (void)playlistIndex:(_Nullable YTIntCompletionHandler)completionHandler;
 
+#pragma mark - Bridge diagnostics
+
+/**
+ * Measures the one-way latency of events from the player page, and counts events that arrived
+ * out of order or were lost. Every event carries the page's sequence number and timestamp; the
+ * clock offset is synchronized the first time this property is read after the player became
+ * ready, so latencies are NAN until that sync is answered, and by
+ * YTPlayerView::synchronizeBridgeClock.
+ */
+@property(nonatomic, readonly, nonnull) YTBridgeLatencyEstimator *bridgeLatencyEstimator;
+
+/**
+ * Sends a clock sync request to the player page, adding a sample to
+ * YTPlayerView::bridgeLatencyEstimator when it is answered. Call it again to follow clock drift
+ * over long sessions.
+ */
+- (void)synchronizeBridgeClock;
+
+/**
+ * Counters describing the bridge health of this player: events per second, scripts waiting for
+ * their evaluation to complete, the latest getter round trip, the time since the latest play time
+ * report, the player state and the seconds buffered ahead. They are kept up to date whether or
+ * not the metrics HUD is shown and reset when a player is loaded.
+ */
+@property(nonatomic, readonly, nonnull) YTPlayerMetrics *metrics;
+
+/**
+ * Whether to overlay YTPlayerView::metrics on the top left corner of the player, refreshed a few
+ * times per second. Intended for debugging on test devices. Defaults to NO.
+ */
+@property(nonatomic) BOOL showsMetricsHUD;
+
+/**
+ * The most recent log records of this player, see YTPlayerLogger for what is recorded. Dump it
+ * to see what led to a failure.
+ */
+@property(nonatomic, readonly, nonnull) YTPlayerLogBuffer *logBuffer;
+
+/**
+ * The scheduler that spreads handling events from the player page over display frames, usually
+ * YTBridgeEventScheduler::sharedScheduler, whose frame budget is then shared with every other
+ * player using it. Events past the budget are handled in later frames, in arrival order. Critical
+ * events (readiness, errors, the end of playback and iframe API loading) are never deferred: the
+ * events this player queued before them are handled first. Only the latest of each kind of play
+ * time, quality and spherical properties report is kept while deferred. Set it to nil to handle
+ * every event as it arrives. Defaults to nil.
+ */
+@property(nonatomic, nullable) YTBridgeEventScheduler *eventScheduler;
+
+#pragma mark - Layout
+
+/**
+ * Whether the player page holds off resizing the player. The page already coalesces resize
+ * events to at most one resize per animation frame and skips resizes that do not change the
+ * size; setting this to YES for the duration of a layout animation, e.g. a rotation or a
+ * collection view layout change, additionally avoids resizing the player at every intermediate
+ * size. Setting it back to NO resizes the player once to its final size. Defaults to NO.
+ */
+@property(nonatomic) BOOL resizesDeferred;
+
+#pragma mark - Spherical video controls
+
+/**
+ * Returns the camera orientation of a 360° video as last reported by the player page. The page
+ * pushes the orientation whenever it changes, so reading this property does not evaluate any
+ * JavaScript. Before the first report, all fields are 0.
+ */
+@property(nonatomic, readonly) YTSphericalProperties sphericalProperties;
+
+/**
+ * Sets the camera orientation of a 360° video. This method corresponds to the
+ * JavaScript API defined here:
+ *   https://developers.google.com/youtube/iframe_api_reference#setSphericalProperties
+ *
+ * This method is safe to call at sensor rate, e.g. from device motion updates. Only the most
+ * recent orientation is kept, and it is forwarded to the player at most once per display frame
+ * in a single JavaScript evaluation.
+ *
+ * @param properties The orientation to move the camera to.
+ */
+- (void)setSphericalProperties:(YTSphericalProperties)properties;
+
+#pragma mark - Hibernation
+
+/** YES between YTPlayerView::hibernate and the next load or YTPlayerView::restoreFromHibernation. */
+@property(nonatomic, readonly, getter=isHibernating) BOOL hibernating;
+
+/**
+ * Releases the web view, and with it the memory of the player page, while remembering the video
+ * or playlist the player is at, the last reported play time and playback rate, and whether the
+ * video was playing. See YTPlayerBudgetManager to hibernate players automatically.
+ *
+ * @return YES if the player is now hibernating, NO if it already was or no player has been
+ *         loaded.
+ */
+- (BOOL)hibernate;
+
+/**
+ * Reloads a hibernated player, seeks it back to the last reported play time and resumes playback
+ * if it was playing when it was hibernated. The video is the one the player was last at, whether
+ * it was loaded, cued, reached through the playlist or the play queue. Loop and shuffle settings
+ * made after loading are not restored.
+ *
+ * @return YES if the player has been reloaded, NO if it was not hibernating.
+ */
+- (BOOL)restoreFromHibernation;
+
 #pragma mark - Exposed for Testing
 
 /**
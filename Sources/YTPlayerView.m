@@ -14,6 +14,14 @@
 
 #import "YTPlayerView.h"
 
+#import "YTPlayerHostView.h"
+#import "YTPlayerMetricsHUDView.h"
+
+NSString *const YTPlayerViewErrorDomain = @"YTPlayerViewErrorDomain";
+
+// The number of log records kept per player.
+static const NSUInteger kYTPlayerLogBufferCapacity = 64;
+
 // These are instances of NSString because we get them from parsing a URL. It would be silly to
 // convert these into an integer just to have to convert the URL query string value into an integer
 // as well for the sake of doing a value comparison. A full list of response error codes can be
@@ -51,25 +59,123 @@ NSString static *const kYTPlayerCallbackOnReady = @"onReady";
 NSString static *const kYTPlayerCallbackOnStateChange = @"onStateChange";
 NSString static *const kYTPlayerCallbackOnPlaybackQualityChange = @"onPlaybackQualityChange";
 NSString static *const kYTPlayerCallbackOnError = @"onError";
+NSString static *const kYTPlayerCallbackOnPlaybackRateChange = @"onPlaybackRateChange";
+NSString static *const kYTPlayerCallbackOnApiChange = @"onApiChange";
+NSString static *const kYTPlayerCallbackOnAutoplayBlocked = @"onAutoplayBlocked";
 NSString static *const kYTPlayerCallbackOnPlayTime = @"onPlayTime";
+NSString static *const kYTPlayerCallbackOnSphericalPropertiesChange = @"onSphericalPropertiesChange";
+NSString static *const kYTPlayerCallbackOnClockSync = @"onClockSync";
 
 NSString static *const kYTPlayerCallbackOnYouTubeIframeAPIReady = @"onYouTubeIframeAPIReady";
 NSString static *const kYTPlayerCallbackOnYouTubeIframeAPIFailedToLoad = @"onYouTubeIframeAPIFailedToLoad";
 
+NSString static *const kYTPlayerDefaultEmbedHost = @"https://www.youtube.com";
+
 NSString static *const kYTPlayerEmbedUrlRegexPattern = @"^http(s)://(www.)youtube.com/embed/(.*)$";
 NSString static *const kYTPlayerAdUrlRegexPattern = @"^http(s)://pubads.g.doubleclick.net/pagead/conversion/";
 NSString static *const kYTPlayerOAuthRegexPattern = @"^http(s)://accounts.google.com/o/oauth2/(.*)$";
 NSString static *const kYTPlayerStaticProxyRegexPattern = @"^https://content.googleapis.com/static/proxy.html(.*)$";
 NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googlesyndication.com/sodar/(.*).html$";
 
+/** The parts of YTPlayerHostView its hosted players load and evaluate through. */
+@interface YTPlayerHostView (YTPlayerView)
+- (NSString *)attachPlayerView:(YTPlayerView *)playerView;
+- (void)detachPlayerWithId:(NSString *)playerId;
+- (void)loadPlayerWithId:(NSString *)playerId
+        playerParamsJSON:(NSString *)playerParamsJSON
+        initialStateJSON:(NSString *)initialStateJSON;
+- (void)evaluateJavaScript:(NSString *)jsToExecute
+               forPlayerId:(NSString *)playerId
+         completionHandler:(void (^)(id result, NSError *error))completionHandler;
+- (void)updateRegionOfPlayerView:(YTPlayerView *)playerView;
+@end
+
+/**
+ * Forwards display link callbacks to a weakly held target, so that a CADisplayLink, which retains
+ * its target, does not keep a YTPlayerView alive.
+ */
+@interface YTWeakDisplayLinkTarget : NSObject
+
+@property(nonatomic, weak) id target;
+@property(nonatomic) SEL selector;
+
+@end
+
+@implementation YTWeakDisplayLinkTarget
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+  id target = self.target;
+  if (!target) {
+    [displayLink invalidate];
+    return;
+  }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+  [target performSelector:self.selector withObject:displayLink];
+#pragma clang diagnostic pop
+}
+
+@end
+
 @interface YTPlayerView() <WKNavigationDelegate, WKUIDelegate>
 
 @property (nonatomic) NSURL *originURL;
 @property (nonatomic, weak) UIView *initialLoadingView;
+@property (nonatomic) YTSphericalProperties sphericalProperties;
+@property (nonatomic) CADisplayLink *sphericalDisplayLink;
+@property (nonatomic) YTBufferEstimator *bufferEstimator;
+@property (nonatomic) YTWatchedRanges *watchedRanges;
+@property (nonatomic) YTCommandEffectTracker *commandEffectTracker;
+@property (nonatomic) YTBridgeLatencyEstimator *bridgeLatencyEstimator;
+@property (nonatomic) YTPlayerMetrics *metrics;
+@property (nonatomic) YTPlayerLogBuffer *logBuffer;
+@property (nonatomic) YTPlayerMetricsHUDView *metricsHUDView;
+@property (nonatomic) CADisplayLink *metricsDisplayLink;
+@property (nonatomic) YTPlayerPageServer *pageServer;
+@property (nonatomic) YTPlayerPageSchemeHandler *pageSchemeHandler API_AVAILABLE(ios(11.0));
+@property (nonatomic) YTPlayerState lastReportedState;
+@property (nonatomic, getter=isHibernating) BOOL hibernating;
 
 @end
 
-@implementation YTPlayerView
+@implementation YTPlayerView {
+  // The latest orientation requested through -setSphericalProperties: that has not been sent to
+  // the page yet. Older requests are overwritten rather than queued.
+  YTSphericalProperties _pendingSphericalProperties;
+  BOOL _hasPendingSphericalProperties;
+  // What the player was last loaded with and how far it got, kept to restore it after
+  // -hibernate.
+  NSString *_loadedPlayerParamsJSON;
+  float _lastPlayTime;
+  float _lastPlaybackRate;
+  // What has replaced the loaded video since, if anything, and the current video and playlist
+  // position as last known from those commands or the page.
+  BOOL _replacedLoadedVideo;
+  NSString *_currentVideoId;
+  id _currentPlaylist;
+  NSInteger _currentPlaylistIndex;
+  // Commands waiting to be sent when YTPlayerView::usesCommandProtocol is set, and how deeply
+  // -performCommandBatch: calls are nested.
+  YTPlayerCommandEncoder *_commandEncoder;
+  NSUInteger _commandBatchDepth;
+  // Whether the iframe API of the current load has not loaded or failed yet, and whether that
+  // load is the probe of YTPlayerView::circuitBreaker.
+  BOOL _awaitingIframeAPI;
+  BOOL _iframeAPIProbe;
+  // The load started by -prepareToLoadWithVideoId:playerVars: that is neither committed nor
+  // cancelled, as a YTPlayerView::speculativeLoadTracker token or 0, and its video.
+  NSUInteger _speculativeLoadToken;
+  NSString *_preparedVideoId;
+  // Whether the player of the current load is ready, and whether to play once it is.
+  BOOL _playerReady;
+  BOOL _playsWhenReady;
+  // Whether the state being reported to the delegate comes from this class rather than the
+  // page, so YTPlayerView::commandEffectTracker must not take it as the effect of a command.
+  BOOL _reportingLocalState;
+  // Whether the bridge clock of the current load has been synchronized since the player became
+  // ready, see YTPlayerView::bridgeLatencyEstimator.
+  BOOL _bridgeClockSynchronized;
+}
 
 - (nonnull instancetype)initWithOriginURL:(nonnull NSURL*)originURL {
     self = [super init];
@@ -79,6 +185,117 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
     return self;
 }
 
+- (nonnull instancetype)initWithHostView:(nonnull YTPlayerHostView *)hostView {
+  self = [self initWithOriginURL:hostView.originURL];
+  if (self) {
+    _hostView = hostView;
+    _playerId = [[hostView attachPlayerView:self] copy];
+    // Touches go to the host's web view underneath.
+    self.userInteractionEnabled = NO;
+  }
+  return self;
+}
+
+- (YTBufferEstimator *)bufferEstimator {
+  if (!_bufferEstimator) {
+    _bufferEstimator = [[YTBufferEstimator alloc] init];
+  }
+  return _bufferEstimator;
+}
+
+- (YTPlayerCircuitBreaker *)circuitBreaker {
+  if (!_circuitBreaker) {
+    _circuitBreaker = [YTPlayerCircuitBreaker sharedBreaker];
+  }
+  return _circuitBreaker;
+}
+
+- (YTSpeculativeLoadTracker *)speculativeLoadTracker {
+  if (!_speculativeLoadTracker) {
+    _speculativeLoadTracker = [YTSpeculativeLoadTracker sharedTracker];
+  }
+  return _speculativeLoadTracker;
+}
+
+- (YTWatchedRanges *)watchedRanges {
+  if (!_watchedRanges) {
+    _watchedRanges = [[YTWatchedRanges alloc] init];
+  }
+  return _watchedRanges;
+}
+
+- (YTCommandEffectTracker *)commandEffectTracker {
+  if (!_commandEffectTracker) {
+    _commandEffectTracker = [[YTCommandEffectTracker alloc] init];
+  }
+  return _commandEffectTracker;
+}
+
+- (NSURL *)embedHostURL {
+  // Hosted players share the iframe API, and therefore the embed host, of their host's page.
+  if (self.hostView) {
+    return self.hostView.embedHostURL;
+  }
+  if (!_embedHostURL) {
+    _embedHostURL = [NSURL URLWithString:kYTPlayerDefaultEmbedHost];
+  }
+  return _embedHostURL;
+}
+
+- (YTBridgeLatencyEstimator *)bridgeLatencyEstimator {
+  // The clock is synchronized once it is first needed rather than on every onReady, since most
+  // players are never asked for their bridge latency.
+  if (_playerReady && !_bridgeClockSynchronized) {
+    [self synchronizeBridgeClock];
+  }
+  return [self latencyEstimator];
+}
+
+/**
+ * Private method returning YTPlayerView::bridgeLatencyEstimator without synchronizing the bridge
+ * clock, for feeding it events.
+ */
+- (YTBridgeLatencyEstimator *)latencyEstimator {
+  if (!_bridgeLatencyEstimator) {
+    _bridgeLatencyEstimator = [[YTBridgeLatencyEstimator alloc] init];
+  }
+  return _bridgeLatencyEstimator;
+}
+
+- (YTPlayerLogBuffer *)logBuffer {
+  if (!_logBuffer) {
+    _logBuffer = [[YTPlayerLogBuffer alloc] initWithCapacity:kYTPlayerLogBufferCapacity];
+    _logBuffer.label = self.playerId;
+  }
+  return _logBuffer;
+}
+
+- (YTPlayerMetrics *)metrics {
+  if (!_metrics) {
+    _metrics = [[YTPlayerMetrics alloc] init];
+  }
+  return _metrics;
+}
+
+- (void)dealloc {
+  [_sphericalDisplayLink invalidate];
+  [_metricsDisplayLink invalidate];
+  if (_awaitingIframeAPI && _iframeAPIProbe) {
+    [_circuitBreaker recordAbandonedAttempt];
+  }
+  if (_speculativeLoadToken) {
+    [_speculativeLoadTracker cancelLoad:_speculativeLoadToken];
+  }
+  if (_playerId) {
+    [_hostView detachPlayerWithId:_playerId];
+  }
+}
+
+- (void)layoutSubviews {
+  [super layoutSubviews];
+  [self.hostView updateRegionOfPlayerView:self];
+}
+
 - (BOOL)loadWithVideoId:(NSString *)videoId {
   return [self loadWithVideoId:videoId playerVars:nil];
 }
@@ -88,14 +305,26 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 }
 
 - (BOOL)loadWithVideoId:(NSString *)videoId playerVars:(NSDictionary *)playerVars {
+  return [self loadWithVideoId:videoId playerVars:playerVars initialState:nil];
+}
+
+- (BOOL)loadWithPlaylistId:(NSString *)playlistId playerVars:(NSDictionary *)playerVars {
+  return [self loadWithPlaylistId:playlistId playerVars:playerVars initialState:nil];
+}
+
+- (BOOL)loadWithVideoId:(NSString *)videoId
+             playerVars:(NSDictionary *)playerVars
+           initialState:(YTPlayerInitialState *)initialState {
   if (!playerVars) {
     playerVars = @{};
   }
   NSDictionary *playerParams = @{ @"videoId" : videoId, @"playerVars" : playerVars };
-  return [self loadWithPlayerParams:playerParams];
+  return [self loadWithPlayerParams:playerParams initialState:initialState];
 }
 
-- (BOOL)loadWithPlaylistId:(NSString *)playlistId playerVars:(NSDictionary *)playerVars {
+- (BOOL)loadWithPlaylistId:(NSString *)playlistId
+                playerVars:(NSDictionary *)playerVars
+              initialState:(YTPlayerInitialState *)initialState {
 
   // Mutable copy because we may have been passed an immutable config dictionary.
   NSMutableDictionary *tempPlayerVars = [[NSMutableDictionary alloc] init];
@@ -106,55 +335,279 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
   }
 
   NSDictionary *playerParams = @{ @"playerVars" : tempPlayerVars };
-  return [self loadWithPlayerParams:playerParams];
+  return [self loadWithPlayerParams:playerParams initialState:initialState];
+}
+
+- (BOOL)loadWithVideoId:(NSString *)videoId
+          configuration:(YTPlayerConfiguration *)configuration {
+  NSString *playlistVideoId = nil;
+  if (configuration.loop && !configuration.hasPlaylist) {
+    playlistVideoId = videoId;
+  }
+  NSString *playerVarsJSON = [configuration playerVarsJSONWithOrigin:self.pageOriginURL.absoluteString
+                                                     playlistVideoId:playlistVideoId];
+  NSString *hostJSON = @"";
+  if ([self usesCustomEmbedHost]) {
+    hostJSON = [NSString stringWithFormat:@",\"host\":%@", YTJSONStringLiteral([self embedHost])];
+  }
+  NSString *playerParamsJSON =
+      [NSString stringWithFormat:@"{\"videoId\":%@,\"height\":\"100%%\",\"width\":\"100%%\","
+                                 "\"events\":%@,\"playerVars\":%@%@}",
+                                 YTJSONStringLiteral(videoId),
+                                 [YTPlayerView playerCallbacksJSON],
+                                 playerVarsJSON,
+                                 hostJSON];
+  return [self loadWithPlayerParamsJSON:playerParamsJSON
+                       initialStateJSON:configuration.initialStateJSON];
+}
+
+#pragma mark - Speculative loading
+
+- (BOOL)prepareToLoadWithVideoId:(NSString *)videoId playerVars:(NSDictionary *)playerVars {
+  if (_speculativeLoadToken && [_preparedVideoId isEqualToString:videoId]) {
+    return YES;
+  }
+  [self cancelPreparedLoad];
+  if (![self loadWithVideoId:videoId playerVars:playerVars]) {
+    return NO;
+  }
+  _speculativeLoadToken = [self.speculativeLoadTracker beginLoadAtTime:CACurrentMediaTime()];
+  _preparedVideoId = [videoId copy];
+  return YES;
+}
+
+- (BOOL)commitPreparedLoad {
+  if (!_speculativeLoadToken) {
+    return NO;
+  }
+  [self.speculativeLoadTracker commitLoad:_speculativeLoadToken atTime:CACurrentMediaTime()];
+  _speculativeLoadToken = 0;
+  _preparedVideoId = nil;
+  if (_playerReady) {
+    [self playVideo];
+  } else {
+    _playsWhenReady = YES;
+  }
+  return YES;
+}
+
+- (void)cancelPreparedLoad {
+  if (!_speculativeLoadToken) {
+    return;
+  }
+  [self removeWebView];
+  [self.initialLoadingView removeFromSuperview];
+}
+
+- (BOOL)isPreparingLoad {
+  return _speculativeLoadToken != 0;
+}
+
+/**
+ * Private method that records the prepared load, if any, as cancelled, e.g. because another load
+ * replaces it.
+ */
+- (void)discardPreparedLoad {
+  if (_speculativeLoadToken) {
+    [self.speculativeLoadTracker cancelLoad:_speculativeLoadToken];
+    _speculativeLoadToken = 0;
+    _preparedVideoId = nil;
+  }
+  _playsWhenReady = NO;
+}
+
+#pragma mark - Command protocol
+
+- (void)performCommandBatch:(void (NS_NOESCAPE ^)(void))commands {
+  _commandBatchDepth++;
+  commands();
+  _commandBatchDepth--;
+  if (_commandBatchDepth == 0) {
+    [self flushCommands];
+  }
+}
+
+/**
+ * Private method that queues a player command for the page when the command protocol is in use.
+ * The command is sent right away unless a -performCommandBatch: block is running.
+ *
+ * @param opcode The command.
+ * @param arguments The arguments of the YT.Player method, or nil for none.
+ * @return NO if the caller should send the command as JavaScript source instead.
+ */
+- (BOOL)sendCommand:(YTPlayerOpcode)opcode arguments:(nullable NSArray *)arguments {
+  if (!self.usesCommandProtocol || self.playerId) {
+    return NO;
+  }
+  if (!_commandEncoder) {
+    _commandEncoder = [[YTPlayerCommandEncoder alloc] init];
+  }
+  if (![_commandEncoder appendCommand:opcode arguments:arguments]) {
+    // The caller sends this command as source right away, so send what precedes it first.
+    [self flushCommands];
+    return NO;
+  }
+  if (_commandBatchDepth == 0) {
+    [self flushCommands];
+  }
+  return YES;
+}
+
+/**
+ * Private method that sends the queued commands to the page in one evaluation.
+ */
+- (void)flushCommands {
+  NSArray *commands = _commandEncoder.commands;
+  if (commands.count == 0) {
+    return;
+  }
+  if (@available(iOS 14.0, *)) {
+    YTPlayerMetrics *metrics = self.metrics;
+    [metrics recordCommandSent];
+    [_webView callAsyncJavaScript:@"dispatchCommands(commands);"
+                        arguments:@{@"commands" : commands}
+                          inFrame:nil
+                   inContentWorld:WKContentWorld.pageWorld
+                completionHandler:^(id _Nullable result, NSError *_Nullable error) {
+                  [metrics recordCommandCompleted];
+                }];
+  } else {
+    NSString *source = [_commandEncoder javaScriptSource];
+    if (source) {
+      [self evaluateJavaScript:source];
+    }
+  }
+  [_commandEncoder removeAllCommands];
 }
 
 #pragma mark - Player methods
 
 - (void)playVideo {
-  [self evaluateJavaScript:@"player.playVideo();"];
+  [self playVideoWithCompletionHandler:nil];
+}
+
+- (void)playVideoWithCompletionHandler:(YTCommandEffectHandler)completionHandler {
+  if (![self sendCommand:kYTPlayerOpcodePlayVideo arguments:nil]) {
+    [self evaluateJavaScript:@"player.playVideo();"];
+  }
+  [self.commandEffectTracker trackCommand:kYTTrackedCommandPlay
+                           expectingState:kYTPlayerStatePlaying
+                                   atTime:CACurrentMediaTime()
+                                  handler:completionHandler];
+  [self scheduleCommandTimeout];
 }
 
 - (void)pauseVideo {
+  [self pauseVideoWithCompletionHandler:nil];
+}
+
+- (void)pauseVideoWithCompletionHandler:(YTCommandEffectHandler)completionHandler {
+  _reportingLocalState = YES;
   [self notifyDelegateOfYouTubeCallbackUrl:[NSURL URLWithString:[NSString stringWithFormat:@"ytplayer://onStateChange?data=%@", kYTPlayerStatePausedCode]]];
-  [self evaluateJavaScript:@"player.pauseVideo();"];
+  _reportingLocalState = NO;
+  if (![self sendCommand:kYTPlayerOpcodePauseVideo arguments:nil]) {
+    [self evaluateJavaScript:@"player.pauseVideo();"];
+  }
+  [self.commandEffectTracker trackCommand:kYTTrackedCommandPause
+                           expectingState:kYTPlayerStatePaused
+                                   atTime:CACurrentMediaTime()
+                                  handler:completionHandler];
+  [self scheduleCommandTimeout];
 }
 
 - (void)stopVideo {
+  if ([self sendCommand:kYTPlayerOpcodeStopVideo arguments:nil]) {
+    return;
+  }
   [self evaluateJavaScript:@"player.stopVideo();"];
 }
 
 - (void)seekToSeconds:(float)seekToSeconds allowSeekAhead:(BOOL)allowSeekAhead {
+  [self seekToSeconds:seekToSeconds allowSeekAhead:allowSeekAhead completionHandler:nil];
+}
+
+- (void)seekToSeconds:(float)seekToSeconds
+       allowSeekAhead:(BOOL)allowSeekAhead
+    completionHandler:(YTCommandEffectHandler)completionHandler {
   NSNumber *secondsValue = [NSNumber numberWithFloat:seekToSeconds];
-  NSString *allowSeekAheadValue = [self stringForJSBoolean:allowSeekAhead];
-  NSString *command = [NSString stringWithFormat:@"player.seekTo(%@, %@);", secondsValue, allowSeekAheadValue];
-  [self evaluateJavaScript:command];
+  if (![self sendCommand:kYTPlayerOpcodeSeekTo arguments:@[ secondsValue, @(allowSeekAhead) ]]) {
+    NSString *allowSeekAheadValue = [self stringForJSBoolean:allowSeekAhead];
+    NSString *command = [NSString stringWithFormat:@"player.seekTo(%@, %@);", secondsValue, allowSeekAheadValue];
+    [self evaluateJavaScript:command];
+  }
+  [self.commandEffectTracker trackSeekToSeconds:seekToSeconds
+                                         atTime:CACurrentMediaTime()
+                                        handler:completionHandler];
+  [self scheduleCommandTimeout];
+}
+
+/**
+ * Private method that makes YTPlayerView::commandEffectTracker time out the command just sent,
+ * if it is still pending by then.
+ */
+- (void)scheduleCommandTimeout {
+  __weak YTPlayerView *weakSelf = self;
+  int64_t delay = (int64_t)(self.commandEffectTracker.timeout * NSEC_PER_SEC);
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), dispatch_get_main_queue(), ^{
+    [weakSelf.commandEffectTracker expireCommandsAtTime:CACurrentMediaTime()];
+  });
 }
 
 #pragma mark - Cueing methods
 
 - (void)cueVideoById:(NSString *)videoId
         startSeconds:(float)startSeconds {
+  [self cueVideoById:videoId startSeconds:startSeconds completionHandler:nil];
+}
+
+- (void)cueVideoById:(NSString *)videoId
+         startSeconds:(float)startSeconds
+    completionHandler:(YTCommandEffectHandler)completionHandler {
+  [self noteLoadedVideoId:videoId playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
-  NSString *command = [NSString stringWithFormat:@"player.cueVideoById('%@', %@);",
-      videoId, startSecondsValue];
-  [self evaluateJavaScript:command];
+  if (![self sendCommand:kYTPlayerOpcodeCueVideoById arguments:@[ videoId, startSecondsValue ]]) {
+    NSString *command = [NSString stringWithFormat:@"player.cueVideoById('%@', %@);",
+        videoId, startSecondsValue];
+    [self evaluateJavaScript:command];
+  }
+  [self.commandEffectTracker trackCommand:kYTTrackedCommandCue
+                           expectingState:kYTPlayerStateCued
+                                   atTime:CACurrentMediaTime()
+                                  handler:completionHandler];
+  [self scheduleCommandTimeout];
 }
 
 - (void)cueVideoById:(NSString *)videoId
         startSeconds:(float)startSeconds
           endSeconds:(float)endSeconds {
+  [self noteLoadedVideoId:videoId playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
   NSNumber *endSecondsValue = [NSNumber numberWithFloat:endSeconds];
-  NSString *command = [NSString stringWithFormat:@"player.cueVideoById({'videoId': '%@',"
-                       "'startSeconds': %@, 'endSeconds': %@});",
-                       videoId, startSecondsValue, endSecondsValue];
-  [self evaluateJavaScript:command];
+  NSDictionary *video = @{
+    @"videoId" : videoId,
+    @"startSeconds" : startSecondsValue,
+    @"endSeconds" : endSecondsValue
+  };
+  if (![self sendCommand:kYTPlayerOpcodeCueVideoById arguments:@[ video ]]) {
+    NSString *command = [NSString stringWithFormat:@"player.cueVideoById({'videoId': '%@',"
+                         "'startSeconds': %@, 'endSeconds': %@});",
+                         videoId, startSecondsValue, endSecondsValue];
+    [self evaluateJavaScript:command];
+  }
+  [self.commandEffectTracker trackCommand:kYTTrackedCommandCue
+                           expectingState:kYTPlayerStateCued
+                                   atTime:CACurrentMediaTime()
+                                  handler:nil];
+  [self scheduleCommandTimeout];
 }
 
 - (void)loadVideoById:(NSString *)videoId
          startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:videoId playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
+  if ([self sendCommand:kYTPlayerOpcodeLoadVideoById arguments:@[ videoId, startSecondsValue ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.loadVideoById('%@', %@);",
       videoId, startSecondsValue];
   [self evaluateJavaScript:command];
@@ -163,8 +616,17 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)loadVideoById:(NSString *)videoId
          startSeconds:(float)startSeconds
            endSeconds:(float)endSeconds {
+  [self noteLoadedVideoId:videoId playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
   NSNumber *endSecondsValue = [NSNumber numberWithFloat:endSeconds];
+  NSDictionary *video = @{
+    @"videoId" : videoId,
+    @"startSeconds" : startSecondsValue,
+    @"endSeconds" : endSecondsValue
+  };
+  if ([self sendCommand:kYTPlayerOpcodeLoadVideoById arguments:@[ video ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.loadVideoById({'videoId': '%@',"
                        "'startSeconds': %@, 'endSeconds': %@});",
                        videoId, startSecondsValue, endSecondsValue];
@@ -173,7 +635,11 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 
 - (void)cueVideoByURL:(NSString *)videoURL
          startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
+  if ([self sendCommand:kYTPlayerOpcodeCueVideoByUrl arguments:@[ videoURL, startSecondsValue ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.cueVideoByUrl('%@', %@);",
       videoURL, startSecondsValue];
   [self evaluateJavaScript:command];
@@ -182,8 +648,13 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)cueVideoByURL:(NSString *)videoURL
          startSeconds:(float)startSeconds
            endSeconds:(float)endSeconds {
+  [self noteLoadedVideoId:nil playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
   NSNumber *endSecondsValue = [NSNumber numberWithFloat:endSeconds];
+  if ([self sendCommand:kYTPlayerOpcodeCueVideoByUrl
+              arguments:@[ videoURL, startSecondsValue, endSecondsValue ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.cueVideoByUrl('%@', %@, %@);",
       videoURL, startSecondsValue, endSecondsValue];
   [self evaluateJavaScript:command];
@@ -191,7 +662,11 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 
 - (void)loadVideoByURL:(NSString *)videoURL
           startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
+  if ([self sendCommand:kYTPlayerOpcodeLoadVideoByUrl arguments:@[ videoURL, startSecondsValue ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.loadVideoByUrl('%@', %@);",
       videoURL, startSecondsValue];
   [self evaluateJavaScript:command];
@@ -200,8 +675,13 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)loadVideoByURL:(NSString *)videoURL
           startSeconds:(float)startSeconds
             endSeconds:(float)endSeconds {
+  [self noteLoadedVideoId:nil playlist:nil index:-1];
   NSNumber *startSecondsValue = [NSNumber numberWithFloat:startSeconds];
   NSNumber *endSecondsValue = [NSNumber numberWithFloat:endSeconds];
+  if ([self sendCommand:kYTPlayerOpcodeLoadVideoByUrl
+              arguments:@[ videoURL, startSecondsValue, endSecondsValue ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.loadVideoByUrl('%@', %@, %@);",
       videoURL, startSecondsValue, endSecondsValue];
   [self evaluateJavaScript:command];
@@ -212,6 +692,11 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)cuePlaylistByPlaylistId:(NSString *)playlistId
                           index:(int)index
                    startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:playlistId index:index];
+  if ([self sendCommand:kYTPlayerOpcodeCuePlaylist
+              arguments:@[ playlistId, @(index), @(startSeconds) ]]) {
+    return;
+  }
   NSString *playlistIdString = [NSString stringWithFormat:@"'%@'", playlistId];
   [self cuePlaylist:playlistIdString
                  index:index
@@ -221,6 +706,11 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)cuePlaylistByVideos:(NSArray *)videoIds
                       index:(int)index
                startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:videoIds index:index];
+  if ([self sendCommand:kYTPlayerOpcodeCuePlaylist
+              arguments:@[ videoIds, @(index), @(startSeconds) ]]) {
+    return;
+  }
   [self cuePlaylist:[self stringFromVideoIdArray:videoIds]
                  index:index
           startSeconds:startSeconds];
@@ -229,6 +719,11 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)loadPlaylistByPlaylistId:(NSString *)playlistId
                            index:(int)index
                     startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:playlistId index:index];
+  if ([self sendCommand:kYTPlayerOpcodeLoadPlaylist
+              arguments:@[ playlistId, @(index), @(startSeconds) ]]) {
+    return;
+  }
   NSString *playlistIdString = [NSString stringWithFormat:@"'%@'", playlistId];
   [self loadPlaylist:playlistIdString
                  index:index
@@ -238,11 +733,45 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 - (void)loadPlaylistByVideos:(NSArray *)videoIds
                        index:(int)index
                 startSeconds:(float)startSeconds {
+  [self noteLoadedVideoId:nil playlist:videoIds index:index];
+  if ([self sendCommand:kYTPlayerOpcodeLoadPlaylist
+              arguments:@[ videoIds, @(index), @(startSeconds) ]]) {
+    return;
+  }
   [self loadPlaylist:[self stringFromVideoIdArray:videoIds]
                  index:index
           startSeconds:startSeconds];
 }
 
+#pragma mark - Play queue
+
+- (void)playQueueItem:(YTPlayQueueItem *)item {
+  [self.playQueue setCurrentItem:item];
+  [self loadPlayQueueItem:item];
+}
+
+- (BOOL)advancePlayQueue {
+  YTPlayQueueItem *item = [self.playQueue advance];
+  if (!item) {
+    return NO;
+  }
+  [self loadPlayQueueItem:item];
+  return YES;
+}
+
+/**
+ * Private method that loads a single play queue item into the existing player.
+ *
+ * @param item The item to load.
+ */
+- (void)loadPlayQueueItem:(YTPlayQueueItem *)item {
+  if (item.endSeconds > 0) {
+    [self loadVideoById:item.videoId startSeconds:item.startSeconds endSeconds:item.endSeconds];
+  } else {
+    [self loadVideoById:item.videoId startSeconds:item.startSeconds];
+  }
+}
+
 #pragma mark - Setting the playback rate
 
 - (void)playbackRate:(_Nullable YTFloatCompletionHandler)completionHandler {
@@ -264,6 +793,9 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 }
 
 - (void)setPlaybackRate:(float)suggestedRate {
+  if ([self sendCommand:kYTPlayerOpcodeSetPlaybackRate arguments:@[ @(suggestedRate) ]]) {
+    return;
+  }
   NSString *command = [NSString stringWithFormat:@"player.setPlaybackRate(%f);", suggestedRate];
   [self evaluateJavaScript:command];
 }
@@ -289,12 +821,18 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 #pragma mark - Setting playback behavior for playlists
 
 - (void)setLoop:(BOOL)loop {
+  if ([self sendCommand:kYTPlayerOpcodeSetLoop arguments:@[ @(loop) ]]) {
+    return;
+  }
   NSString *loopPlayListValue = [self stringForJSBoolean:loop];
   NSString *command = [NSString stringWithFormat:@"player.setLoop(%@);", loopPlayListValue];
   [self evaluateJavaScript:command];
 }
 
 - (void)setShuffle:(BOOL)shuffle {
+  if ([self sendCommand:kYTPlayerOpcodeSetShuffle arguments:@[ @(shuffle) ]]) {
+    return;
+  }
   NSString *shufflePlayListValue = [self stringForJSBoolean:shuffle];
   NSString *command = [NSString stringWithFormat:@"player.setShuffle(%@);", shufflePlayListValue];
   [self evaluateJavaScript:command];
@@ -453,69 +991,352 @@ NSString static *const kYTPlayerSyndicationRegexPattern = @"^https://tpc.googles
 #pragma mark - Playing a video in a playlist
 
 - (void)nextVideo {
+  if ([self sendCommand:kYTPlayerOpcodeNextVideo arguments:nil]) {
+    return;
+  }
   [self evaluateJavaScript:@"player.nextVideo();"];
 }
 
 - (void)previousVideo {
+  if ([self sendCommand:kYTPlayerOpcodePreviousVideo arguments:nil]) {
+    return;
+  }
   [self evaluateJavaScript:@"player.previousVideo();"];
 }
 
 - (void)playVideoAt:(int)index {
+  if ([self sendCommand:kYTPlayerOpcodePlayVideoAt arguments:@[ @(index) ]]) {
+    return;
+  }
   NSString *command =
       [NSString stringWithFormat:@"player.playVideoAt(%@);", [NSNumber numberWithInt:index]];
   [self evaluateJavaScript:command];
 }
 
-#pragma mark - Helper methods
+#pragma mark - Bridge diagnostics
+
+- (void)synchronizeBridgeClock {
+  _bridgeClockSynchronized = _bridgeClockSynchronized || _playerReady;
+  NSString *command =
+      [NSString stringWithFormat:@"syncClock(%.6f);", CACurrentMediaTime()];
+  [self evaluateJavaScript:command];
+}
+
+- (void)setShowsMetricsHUD:(BOOL)showsMetricsHUD {
+  if (_showsMetricsHUD == showsMetricsHUD) {
+    return;
+  }
+  _showsMetricsHUD = showsMetricsHUD;
+  if (showsMetricsHUD) {
+    self.metricsHUDView = [[YTPlayerMetricsHUDView alloc] initWithFrame:CGRectMake(4, 4, 0, 0)];
+    [self addSubview:self.metricsHUDView];
+    [self refreshMetricsHUD:nil];
+
+    YTWeakDisplayLinkTarget *target = [[YTWeakDisplayLinkTarget alloc] init];
+    target.target = self;
+    target.selector = @selector(refreshMetricsHUD:);
+    self.metricsDisplayLink = [CADisplayLink displayLinkWithTarget:target
+                                                          selector:@selector(displayLinkDidFire:)];
+    // A few refreshes per second are enough to read the numbers.
+    self.metricsDisplayLink.preferredFramesPerSecond = 4;
+    [self.metricsDisplayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+  } else {
+    [self.metricsDisplayLink invalidate];
+    self.metricsDisplayLink = nil;
+    [self.metricsHUDView removeFromSuperview];
+    self.metricsHUDView = nil;
+  }
+}
 
 /**
- * Convert a quality value from NSString to the typed enum value.
+ * Private method called by the metrics display link to show the latest metrics in the HUD.
  *
- * @param qualityString A string representing playback quality. Ex: "small", "medium", "hd1080".
- * @return An enum value representing the playback quality.
+ * @param displayLink The display link that fired.
  */
-+ (YTPlaybackQuality)playbackQualityForString:(NSString *)qualityString {
-  YTPlaybackQuality quality = kYTPlaybackQualityUnknown;
+- (void)refreshMetricsHUD:(CADisplayLink *)displayLink {
+  [self.metricsHUDView showSnapshot:[self.metrics snapshotAtTime:CACurrentMediaTime()]];
+  [self bringSubviewToFront:self.metricsHUDView];
+}
 
-  if ([qualityString isEqualToString:kYTPlaybackQualitySmallQuality]) {
-    quality = kYTPlaybackQualitySmall;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityMediumQuality]) {
-    quality = kYTPlaybackQualityMedium;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityLargeQuality]) {
-    quality = kYTPlaybackQualityLarge;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityHD720Quality]) {
-    quality = kYTPlaybackQualityHD720;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityHD1080Quality]) {
-    quality = kYTPlaybackQualityHD1080;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityHighResQuality]) {
-    quality = kYTPlaybackQualityHighRes;
-  } else if ([qualityString isEqualToString:kYTPlaybackQualityAutoQuality]) {
-    quality = kYTPlaybackQualityAuto;
+#pragma mark - Layout
+
+- (void)setResizesDeferred:(BOOL)resizesDeferred {
+  if (_resizesDeferred == resizesDeferred) {
+    return;
   }
+  _resizesDeferred = resizesDeferred;
+  NSString *command = [NSString stringWithFormat:@"setResizesDeferred(%@);",
+                                                 [self stringForJSBoolean:resizesDeferred]];
+  [self evaluateJavaScript:command];
+}
 
-  return quality;
+#pragma mark - Spherical video controls
+
+- (void)setSphericalProperties:(YTSphericalProperties)properties {
+  _pendingSphericalProperties = properties;
+  _hasPendingSphericalProperties = YES;
+  if (!self.sphericalDisplayLink) {
+    YTWeakDisplayLinkTarget *target = [[YTWeakDisplayLinkTarget alloc] init];
+    target.target = self;
+    target.selector = @selector(flushSphericalProperties:);
+    self.sphericalDisplayLink = [CADisplayLink displayLinkWithTarget:target
+                                                            selector:@selector(displayLinkDidFire:)];
+    [self.sphericalDisplayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+  }
 }
 
 /**
- * Convert a state value from NSString to the typed enum value.
+ * Private method called once per display frame while spherical updates are arriving. Sends the
+ * latest pending orientation, or stops the display link once updates have stopped.
  *
- * @param stateString A string representing player state. Ex: "-1", "0", "1".
- * @return An enum value representing the player state.
+ * @param displayLink The display link that fired.
  */
-+ (YTPlayerState)playerStateForString:(NSString *)stateString {
-  YTPlayerState state = kYTPlayerStateUnknown;
-  if ([stateString isEqualToString:kYTPlayerStateUnstartedCode]) {
-    state = kYTPlayerStateUnstarted;
-  } else if ([stateString isEqualToString:kYTPlayerStateEndedCode]) {
-    state = kYTPlayerStateEnded;
-  } else if ([stateString isEqualToString:kYTPlayerStatePlayingCode]) {
-    state = kYTPlayerStatePlaying;
-  } else if ([stateString isEqualToString:kYTPlayerStatePausedCode]) {
-    state = kYTPlayerStatePaused;
-  } else if ([stateString isEqualToString:kYTPlayerStateBufferingCode]) {
-    state = kYTPlayerStateBuffering;
-  } else if ([stateString isEqualToString:kYTPlayerStateCuedCode]) {
-    state = kYTPlayerStateCued;
+- (void)flushSphericalProperties:(CADisplayLink *)displayLink {
+  if (!_hasPendingSphericalProperties) {
+    [self stopSphericalDisplayLink];
+    return;
+  }
+  _hasPendingSphericalProperties = NO;
+  YTSphericalProperties properties = _pendingSphericalProperties;
+  NSDictionary *sphericalArguments = @{
+    @"yaw" : @(properties.yaw),
+    @"pitch" : @(properties.pitch),
+    @"roll" : @(properties.roll),
+    @"fov" : @(properties.fieldOfView)
+  };
+  if ([self sendCommand:kYTPlayerOpcodeSetSphericalProperties arguments:@[ sphericalArguments ]]) {
+    return;
+  }
+  NSString *command = [NSString stringWithFormat:@"player.setSphericalProperties("
+                                                 "{yaw: %f, pitch: %f, roll: %f, fov: %f});",
+                                                 properties.yaw,
+                                                 properties.pitch,
+                                                 properties.roll,
+                                                 properties.fieldOfView];
+  [self evaluateJavaScript:command];
+}
+
+- (void)stopSphericalDisplayLink {
+  [self.sphericalDisplayLink invalidate];
+  self.sphericalDisplayLink = nil;
+  _hasPendingSphericalProperties = NO;
+}
+
+#pragma mark - Hibernation
+
+- (BOOL)hibernate {
+  if (self.hibernating || !self.webView || !_loadedPlayerParamsJSON) {
+    return NO;
+  }
+  YTPlayerLog(kYTPlayerLogLevelInfo, self.logBuffer, @"Hibernating");
+  [self removeWebView];
+  [self.initialLoadingView removeFromSuperview];
+  self.hibernating = YES;
+  return YES;
+}
+
+- (BOOL)restoreFromHibernation {
+  if (!self.hibernating) {
+    return NO;
+  }
+  // Built directly rather than from a YTPlayerInitialState, whose playlist index always plays.
+  NSMutableDictionary *initialState = [[NSMutableDictionary alloc] init];
+  NSString *playerParamsJSON = [self playerParamsJSONForRestoringWithInitialState:initialState];
+  if (_lastPlayTime > 0) {
+    initialState[@"seekToSeconds"] = @(_lastPlayTime);
+  }
+  if (_lastPlaybackRate > 0 && _lastPlaybackRate != 1) {
+    initialState[@"playbackRate"] = @(_lastPlaybackRate);
+  }
+  if (self.lastReportedState == kYTPlayerStatePlaying ||
+      self.lastReportedState == kYTPlayerStateBuffering) {
+    initialState[@"playVideo"] = @YES;
+  }
+  NSData *initialStateData = [NSJSONSerialization dataWithJSONObject:initialState
+                                                             options:0
+                                                               error:nil];
+  if (!initialStateData) {
+    return NO;
+  }
+
+  float playTime = _lastPlayTime;
+  float playbackRate = _lastPlaybackRate;
+  NSInteger playlistIndex = _currentPlaylistIndex;
+  if (![self loadWithPlayerParamsJSON:playerParamsJSON
+                     initialStateJSON:[[NSString alloc] initWithData:initialStateData
+                                                            encoding:NSUTF8StringEncoding]]) {
+    return NO;
+  }
+  // The page reports play time again once playback resumes; until then, keep what was restored.
+  _lastPlayTime = playTime;
+  _lastPlaybackRate = playbackRate;
+  _currentPlaylistIndex = playlistIndex;
+  return YES;
+}
+
+/**
+ * Private method that rebuilds the player parameters of the current load for the video or
+ * playlist the player was last at, which later load and cue commands, playlist navigation and
+ * play queue advances may have changed.
+ *
+ * @param initialState Receives the playlist and the index to cue or load it at, see
+ *                     applyInitialState() in the bridge script.
+ * @return The player parameters as a JSON object.
+ */
+- (NSString *)playerParamsJSONForRestoringWithInitialState:(NSMutableDictionary *)initialState {
+  NSData *data = [_loadedPlayerParamsJSON dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableDictionary *playerParams =
+      [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+  if (![playerParams isKindOfClass:[NSMutableDictionary class]]) {
+    return _loadedPlayerParamsJSON;
+  }
+  NSMutableDictionary *playerVars = [playerParams[@"playerVars"] mutableCopy];
+  if (![playerVars isKindOfClass:[NSMutableDictionary class]]) {
+    playerVars = [NSMutableDictionary dictionary];
+  }
+  BOOL definesPlaylist = playerVars[@"list"] != nil || playerVars[@"playlist"] != nil;
+
+  if (_currentPlaylist) {
+    [playerParams removeObjectForKey:@"videoId"];
+    [playerVars removeObjectsForKeys:@[ @"list", @"listType", @"playlist" ]];
+    if ([_currentPlaylist isKindOfClass:[NSString class]]) {
+      playerVars[@"listType"] = @"playlist";
+      playerVars[@"list"] = _currentPlaylist;
+    } else if ([_currentPlaylist count] > 0) {
+      NSArray *videoIds = _currentPlaylist;
+      playerParams[@"videoId"] = videoIds[0];
+      if (videoIds.count > 1) {
+        playerVars[@"playlist"] =
+            [[videoIds subarrayWithRange:NSMakeRange(1, videoIds.count - 1)]
+                componentsJoinedByString:@","];
+      }
+    }
+  } else if (_currentVideoId && (_replacedLoadedVideo || !definesPlaylist)) {
+    // A single video, looped by a playlist of itself if the player loops.
+    playerParams[@"videoId"] = _currentVideoId;
+    [playerVars removeObjectsForKeys:@[ @"list", @"listType", @"playlist" ]];
+    if ([playerVars[@"loop"] boolValue]) {
+      playerVars[@"playlist"] = _currentVideoId;
+    }
+    return [self JSONStringForPlayerParams:playerParams playerVars:playerVars];
+  } else if (!definesPlaylist) {
+    return _loadedPlayerParamsJSON;
+  }
+  if (_currentPlaylistIndex >= 0) {
+    // The playlist as the page loads it: a list and its type, or the video and the rest.
+    if (playerVars[@"list"]) {
+      initialState[@"playlist"] = playerVars[@"list"];
+      initialState[@"listType"] = playerVars[@"listType"] ?: @"playlist";
+    } else {
+      NSMutableArray *videoIds = [NSMutableArray array];
+      if (playerParams[@"videoId"]) {
+        [videoIds addObject:playerParams[@"videoId"]];
+      }
+      if ([playerVars[@"playlist"] isKindOfClass:[NSString class]]) {
+        [videoIds addObjectsFromArray:[playerVars[@"playlist"] componentsSeparatedByString:@","]];
+      }
+      initialState[@"playlist"] = videoIds;
+    }
+    initialState[@"playlistIndex"] = @(_currentPlaylistIndex);
+  }
+  return [self JSONStringForPlayerParams:playerParams playerVars:playerVars];
+}
+
+/**
+ * Private helper method serializing |playerParams| with |playerVars| as its player variables.
+ */
+- (NSString *)JSONStringForPlayerParams:(NSMutableDictionary *)playerParams
+                             playerVars:(NSDictionary *)playerVars {
+  playerParams[@"playerVars"] = playerVars;
+  NSData *data = [NSJSONSerialization dataWithJSONObject:playerParams options:0 error:nil];
+  return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+/**
+ * Private method recording what a load or cue command replaced the loaded video with, so that
+ * -restoreFromHibernation restores it rather than what the player was first loaded with.
+ *
+ * @param videoId The video, or nil if it is not known until the page reports it, e.g. for
+ *                videos loaded by URL.
+ * @param playlist A playlist ID or an array of video IDs, or nil.
+ * @param index The position to start at in |playlist|.
+ */
+- (void)noteLoadedVideoId:(NSString *)videoId playlist:(id)playlist index:(int)index {
+  _replacedLoadedVideo = YES;
+  _currentVideoId = [videoId copy];
+  _currentPlaylist = [playlist copy];
+  _currentPlaylistIndex = playlist ? index : -1;
+}
+
+#pragma mark - Helper methods
+
+/**
+ * Convert a quality value from NSString to the typed enum value.
+ *
+ * @param qualityString A string representing playback quality. Ex: "small", "medium", "hd1080".
+ * @return An enum value representing the playback quality.
+ */
++ (YTPlaybackQuality)playbackQualityForString:(NSString *)qualityString {
+  YTPlaybackQuality quality = kYTPlaybackQualityUnknown;
+
+  if ([qualityString isEqualToString:kYTPlaybackQualitySmallQuality]) {
+    quality = kYTPlaybackQualitySmall;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityMediumQuality]) {
+    quality = kYTPlaybackQualityMedium;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityLargeQuality]) {
+    quality = kYTPlaybackQualityLarge;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityHD720Quality]) {
+    quality = kYTPlaybackQualityHD720;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityHD1080Quality]) {
+    quality = kYTPlaybackQualityHD1080;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityHighResQuality]) {
+    quality = kYTPlaybackQualityHighRes;
+  } else if ([qualityString isEqualToString:kYTPlaybackQualityAutoQuality]) {
+    quality = kYTPlaybackQualityAuto;
+  }
+
+  return quality;
+}
+
+/**
+ * Parse the query of a callback URL into its parameters.
+ *
+ * @param query A query string of the format "data=value&key=value".
+ * @return A dictionary of parameter values keyed by name, empty if |query| is nil.
+ */
++ (NSDictionary<NSString *, NSString *> *)parametersForQuery:(NSString *)query {
+  NSMutableDictionary<NSString *, NSString *> *parameters = [[NSMutableDictionary alloc] init];
+  for (NSString *pair in [query componentsSeparatedByString:@"&"]) {
+    NSRange separator = [pair rangeOfString:@"="];
+    if (separator.location == NSNotFound) {
+      continue;
+    }
+    NSString *key = [pair substringToIndex:separator.location];
+    parameters[key] = [pair substringFromIndex:NSMaxRange(separator)];
+  }
+  return parameters;
+}
+
+/**
+ * Convert a state value from NSString to the typed enum value.
+ *
+ * @param stateString A string representing player state. Ex: "-1", "0", "1".
+ * @return An enum value representing the player state.
+ */
++ (YTPlayerState)playerStateForString:(NSString *)stateString {
+  YTPlayerState state = kYTPlayerStateUnknown;
+  if ([stateString isEqualToString:kYTPlayerStateUnstartedCode]) {
+    state = kYTPlayerStateUnstarted;
+  } else if ([stateString isEqualToString:kYTPlayerStateEndedCode]) {
+    state = kYTPlayerStateEnded;
+  } else if ([stateString isEqualToString:kYTPlayerStatePlayingCode]) {
+    state = kYTPlayerStatePlaying;
+  } else if ([stateString isEqualToString:kYTPlayerStatePausedCode]) {
+    state = kYTPlayerStatePaused;
+  } else if ([stateString isEqualToString:kYTPlayerStateBufferingCode]) {
+    state = kYTPlayerStateBuffering;
+  } else if ([stateString isEqualToString:kYTPlayerStateCuedCode]) {
+    state = kYTPlayerStateCued;
   }
   return state;
 }
@@ -527,7 +1348,7 @@ decidePolicyForNavigationAction:(WKNavigationAction *)navigationAction
 decisionHandler:(void (^)(WKNavigationActionPolicy))decisionHandler {
   NSURLRequest *request = navigationAction.request;
   if ([request.URL.scheme isEqual:@"ytplayer"]) {
-    [self notifyDelegateOfYouTubeCallbackUrl:request.URL];
+    [self dispatchYouTubeCallbackUrl:request.URL];
     decisionHandler(WKNavigationActionPolicyCancel);
     return;
   } else if ([request.URL.scheme isEqual: @"http"] || [request.URL.scheme isEqual:@"https"]) {
@@ -573,6 +1394,138 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
   return _originURL;
 }
 
+/**
+ * Private method returning YTPlayerView::embedHostURL as a string without trailing slash, as
+ * used in the page template and the player parameters.
+ */
+- (NSString *)embedHost {
+  return [YTPlayerView embedHostOfURL:self.embedHostURL];
+}
+
+/**
+ * Private helper method returning |embedHostURL| as a string without trailing slash. Also used by
+ * YTPlayerHostView to render its page.
+ */
++ (NSString *)embedHostOfURL:(NSURL *)embedHostURL {
+  NSString *embedHost = embedHostURL.absoluteString;
+  while ([embedHost hasSuffix:@"/"]) {
+    embedHost = [embedHost substringToIndex:embedHost.length - 1];
+  }
+  return embedHost;
+}
+
+/**
+ * Private method returning whether YTPlayerView::embedHostURL was changed from its default.
+ */
+- (BOOL)usesCustomEmbedHost {
+  return ![[self embedHost] isEqualToString:kYTPlayerDefaultEmbedHost];
+}
+
+/**
+ * Private method returning whether |url| has the scheme, host and port of
+ * YTPlayerView::embedHostURL.
+ */
+- (BOOL)isEmbedHostURL:(NSURL *)url {
+  return [YTPlayerView isURL:url onEmbedHostURL:self.embedHostURL];
+}
+
+/**
+ * Private helper method returning whether |url| has the scheme, host and port of
+ * |embedHostURL|. Also used by YTPlayerHostView to allow the embeds of its embed host.
+ */
++ (BOOL)isURL:(NSURL *)url onEmbedHostURL:(NSURL *)embedHostURL {
+  return [[url.scheme lowercaseString] isEqualToString:[embedHostURL.scheme lowercaseString]] &&
+         [[url.host lowercaseString] isEqualToString:[embedHostURL.host lowercaseString]] &&
+         (url.port == embedHostURL.port || [url.port isEqual:embedHostURL.port]);
+}
+
+/**
+ * Private method returning whether the page is served by a YTPlayerPageSchemeHandler.
+ */
+- (BOOL)usesPageSchemeHandler {
+  if (self.playerId) {
+    return NO;
+  }
+  if (@available(iOS 11.0, *)) {
+    return self.servesPageFromMemory;
+  }
+  return NO;
+}
+
+/**
+ * Private method returning the origin of the player page: the origin URL when the page is loaded
+ * with it as base URL, or the same host under kYTPlayerPageURLScheme when it is served from
+ * memory.
+ */
+- (NSURL *)pageOriginURL {
+  if (![self usesPageSchemeHandler]) {
+    return self.originURL;
+  }
+  NSURLComponents *components = [[NSURLComponents alloc] init];
+  components.scheme = kYTPlayerPageURLScheme;
+  components.host = self.originURL.host;
+  return components.URL;
+}
+
+- (YTPlayerPageServer *)pageServer {
+  if (!_pageServer) {
+    NSString *bridgeScript = [YTPlayerView bridgeScript];
+    if (bridgeScript) {
+      _pageServer = [[YTPlayerPageServer alloc] initWithBridgeScript:bridgeScript];
+    }
+  }
+  return _pageServer;
+}
+
+/**
+ * Private method handling a callback URL from the player page, right away or, when
+ * YTPlayerView::eventScheduler is set, within the budget of a later display frame.
+ *
+ * @param url A URL of the format ytplayer://action?data=value.
+ */
+- (void)dispatchYouTubeCallbackUrl:(NSURL *)url {
+  NSTimeInterval receiveTime = CACurrentMediaTime();
+  if (!self.eventScheduler) {
+    [self notifyDelegateOfYouTubeCallbackUrl:url receiveTime:receiveTime];
+    return;
+  }
+  __weak YTPlayerView *weakSelf = self;
+  // Events are handled with the time they arrived, so that deferring them does not skew the
+  // samples taken from them.
+  [self.eventScheduler scheduleEventFromSource:self
+                                      priority:[YTPlayerView priorityOfCallbackUrl:url]
+                                 coalescingKey:url.host
+                                       handler:^{
+    [weakSelf notifyDelegateOfYouTubeCallbackUrl:url receiveTime:receiveTime];
+  }];
+}
+
+/**
+ * Private method returning how urgently a callback URL must be handled. Events that change what
+ * the app must do next are critical; periodic reports are low priority.
+ */
++ (YTBridgeEventPriority)priorityOfCallbackUrl:(NSURL *)url {
+  NSString *action = url.host;
+  if ([action isEqualToString:kYTPlayerCallbackOnReady] ||
+      [action isEqualToString:kYTPlayerCallbackOnError] ||
+      [action isEqualToString:kYTPlayerCallbackOnAutoplayBlocked] ||
+      [action isEqualToString:kYTPlayerCallbackOnYouTubeIframeAPIReady] ||
+      [action isEqualToString:kYTPlayerCallbackOnYouTubeIframeAPIFailedToLoad]) {
+    return kYTBridgeEventPriorityCritical;
+  }
+  if ([action isEqualToString:kYTPlayerCallbackOnStateChange]) {
+    NSString *state = [YTPlayerView parametersForQuery:url.query][@"data"];
+    return [state isEqualToString:kYTPlayerStateEndedCode] ? kYTBridgeEventPriorityCritical
+                                                            : kYTBridgeEventPriorityNormal;
+  }
+  if ([action isEqualToString:kYTPlayerCallbackOnPlayTime] ||
+      [action isEqualToString:kYTPlayerCallbackOnPlaybackQualityChange] ||
+      [action isEqualToString:kYTPlayerCallbackOnSphericalPropertiesChange]) {
+    return kYTBridgeEventPriorityLow;
+  }
+  return kYTBridgeEventPriorityNormal;
+}
+
 /**
  * Private method to handle "navigation" to a callback URL of the format
  * ytplayer://action?data=someData
@@ -582,34 +1535,86 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
  * @param url A URL of the format ytplayer://action?data=value.
  */
 - (void)notifyDelegateOfYouTubeCallbackUrl:(NSURL *) url {
+  [self notifyDelegateOfYouTubeCallbackUrl:url receiveTime:CACurrentMediaTime()];
+}
+
+/**
+ * Private method handling a callback URL that arrived at |receiveTime|, which is earlier than
+ * now when the event was deferred.
+ *
+ * @param url A URL of the format ytplayer://action?data=value.
+ * @param receiveTime When the event arrived from the page.
+ */
+- (void)notifyDelegateOfYouTubeCallbackUrl:(NSURL *)url receiveTime:(NSTimeInterval)receiveTime {
   NSString *action = url.host;
 
-  // We know the query can only be of the format ytplayer://action?data=SOMEVALUE,
-  // so we parse out the value.
-  NSString *query = url.query;
-  NSString *data;
-  if (query) {
-    data = [query componentsSeparatedByString:@"="][1];
+  // The query is of the format ytplayer://action?data=SOMEVALUE, optionally followed by
+  // further &key=value parameters for some actions.
+  NSDictionary<NSString *, NSString *> *parameters = [YTPlayerView parametersForQuery:url.query];
+  NSString *data = parameters[@"data"];
+  YTPlayerLog(kYTPlayerLogLevelDebug, self.logBuffer, @"Event %@ %@", action, url.query);
+  [self.metrics recordEventAtTime:receiveTime];
+
+  // Events from the player page are stamped with a sequence number and the page time in
+  // milliseconds, see sendEvent() in the player page.
+  NSString *sequenceNumber = parameters[@"seq"];
+  NSTimeInterval pageTime = [parameters[@"ts"] doubleValue] / 1000;
+  if (sequenceNumber) {
+    [[self latencyEstimator] recordEventWithSequenceNumber:[sequenceNumber integerValue]
+                                                 pageTime:pageTime
+                                        nativeReceiveTime:receiveTime];
   }
 
   if ([action isEqual:kYTPlayerCallbackOnReady]) {
     if (self.initialLoadingView) {
       [self.initialLoadingView removeFromSuperview];
     }
+    _playerReady = YES;
+    YTPlayerLog(kYTPlayerLogLevelInfo, self.logBuffer, @"Player ready");
     if ([self.delegate respondsToSelector:@selector(playerViewDidBecomeReady:)]) {
       [self.delegate playerViewDidBecomeReady:self];
     }
+    if (_playsWhenReady) {
+      _playsWhenReady = NO;
+      [self playVideo];
+    }
   } else if ([action isEqual:kYTPlayerCallbackOnStateChange]) {
+    YTPlayerState state = [YTPlayerView playerStateForString:data];
+    YTPlayerLog(kYTPlayerLogLevelInfo, self.logBuffer, @"State changed to %@", data);
+    self.lastReportedState = state;
+    self.metrics.playerState = state;
+    // The page reports the video and playlist position along with each state change, which
+    // follows playlist navigation and autoplay that no command announced.
+    NSString *videoId = parameters[@"video"];
+    if (videoId.length > 0) {
+      _currentVideoId = videoId;
+    }
+    NSString *playlistIndex = parameters[@"index"];
+    if (playlistIndex) {
+      _currentPlaylistIndex = [playlistIndex integerValue];
+    }
+    if (state == kYTPlayerStateUnstarted) {
+      // A new video is starting.
+      [self.watchedRanges reset];
+    } else if (state != kYTPlayerStatePlaying) {
+      [self.watchedRanges interruptSampling];
+    }
     if ([self.delegate respondsToSelector:@selector(playerView:didChangeToState:)]) {
-      YTPlayerState state = [YTPlayerView playerStateForString:data];
       [self.delegate playerView:self didChangeToState:state];
     }
+    if (!_reportingLocalState) {
+      [self.commandEffectTracker observeState:state atTime:receiveTime];
+    }
+    if (state == kYTPlayerStateEnded && self.playQueue) {
+      [self advancePlayQueue];
+    }
   } else if ([action isEqual:kYTPlayerCallbackOnPlaybackQualityChange]) {
     if ([self.delegate respondsToSelector:@selector(playerView:didChangeToQuality:)]) {
       YTPlaybackQuality quality = [YTPlayerView playbackQualityForString:data];
       [self.delegate playerView:self didChangeToQuality:quality];
     }
   } else if ([action isEqual:kYTPlayerCallbackOnError]) {
+    YTPlayerLog(kYTPlayerLogLevelError, self.logBuffer, @"Player error %@", data);
     if ([self.delegate respondsToSelector:@selector(playerView:receivedError:)]) {
       YTPlayerError error = kYTPlayerErrorUnknown;
 
@@ -627,15 +1632,86 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
 
       [self.delegate playerView:self receivedError:error];
     }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnPlaybackRateChange]) {
+    float playbackRate = [data floatValue];
+    _lastPlaybackRate = playbackRate;
+    if ([self.delegate respondsToSelector:@selector(playerView:didChangeToPlaybackRate:)]) {
+      [self.delegate playerView:self didChangeToPlaybackRate:playbackRate];
+    }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnApiChange]) {
+    if ([self.delegate respondsToSelector:@selector(playerView:didChangeAPIModules:)]) {
+      // The page reports the loaded modules as a percent-encoded, comma-separated list.
+      NSString *modules = [data stringByRemovingPercentEncoding];
+      NSArray<NSString *> *moduleNames =
+          modules.length > 0 ? [modules componentsSeparatedByString:@","] : @[];
+      [self.delegate playerView:self didChangeAPIModules:moduleNames];
+    }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnAutoplayBlocked]) {
+    YTPlayerLog(kYTPlayerLogLevelWarning, self.logBuffer, @"Autoplay blocked");
+    if ([self.delegate respondsToSelector:@selector(playerViewAutoplayWasBlocked:)]) {
+      [self.delegate playerViewAutoplayWasBlocked:self];
+    }
   } else if ([action isEqualToString:kYTPlayerCallbackOnPlayTime]) {
+    float time = [data floatValue];
+    _lastPlayTime = time;
+    [self.metrics recordPlayTimeAtTime:receiveTime];
     if ([self.delegate respondsToSelector:@selector(playerView:didPlayTime:)]) {
-      float time = [data floatValue];
       [self.delegate playerView:self didPlayTime:time];
     }
+    [self.commandEffectTracker observePlayTime:time atTime:receiveTime];
+    // Play time reports also carry the buffer state, see getCurrentTime() in the player page.
+    NSString *loadedFraction = parameters[@"loaded"];
+    if (loadedFraction) {
+      _lastPlaybackRate = [parameters[@"rate"] floatValue];
+      self.watchedRanges.duration = [parameters[@"duration"] doubleValue];
+      [self.watchedRanges addSampleWithCurrentTime:time
+                                      playbackRate:_lastPlaybackRate
+                                         timestamp:receiveTime];
+      BOOL stallPredicted =
+          [self.bufferEstimator addSampleWithCurrentTime:time
+                                          loadedFraction:[loadedFraction doubleValue]
+                                                duration:[parameters[@"duration"] doubleValue]
+                                            playbackRate:[parameters[@"rate"] doubleValue]
+                                               timestamp:receiveTime];
+      self.metrics.bufferedAheadSeconds = self.bufferEstimator.bufferedAheadSeconds;
+      if (stallPredicted &&
+          [self.delegate respondsToSelector:@selector(playerView:predictsRebufferInSeconds:)]) {
+        [self.delegate playerView:self
+            predictsRebufferInSeconds:self.bufferEstimator.secondsUntilStall];
+      }
+    }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnSphericalPropertiesChange]) {
+    // The page reports the orientation as "yaw,pitch,roll,fov".
+    NSArray<NSString *> *components = [data componentsSeparatedByString:@","];
+    if (components.count == 4) {
+      YTSphericalProperties properties;
+      properties.yaw = [components[0] floatValue];
+      properties.pitch = [components[1] floatValue];
+      properties.roll = [components[2] floatValue];
+      properties.fieldOfView = [components[3] floatValue];
+      self.sphericalProperties = properties;
+    }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnClockSync]) {
+    if (sequenceNumber) {
+      [[self latencyEstimator] addSyncSampleWithNativeSendTime:[data doubleValue]
+                                                     pageTime:pageTime
+                                            nativeReceiveTime:receiveTime];
+    }
+  } else if ([action isEqualToString:kYTPlayerCallbackOnYouTubeIframeAPIReady]) {
+    if (_awaitingIframeAPI) {
+      _awaitingIframeAPI = NO;
+      [self.circuitBreaker recordSuccess];
+    }
   } else if ([action isEqualToString:kYTPlayerCallbackOnYouTubeIframeAPIFailedToLoad]) {
     if (self.initialLoadingView) {
       [self.initialLoadingView removeFromSuperview];
     }
+    YTPlayerLog(kYTPlayerLogLevelError, self.logBuffer, @"Failed to load the iframe API");
+    if (_awaitingIframeAPI) {
+      _awaitingIframeAPI = NO;
+      [self.circuitBreaker recordFailureAtTime:receiveTime];
+    }
+    [self notifyDelegateOfIframeAPIError:kYTPlayerViewErrorIframeAPIFailedToLoad];
   }
 }
 
@@ -647,67 +1723,75 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
   if ([[url.host lowercaseString] isEqualToString:[self.originURL.host lowercaseString]]) {
     return YES;
   }
+  // The embed of a custom embed host, e.g. a local stand-in, loads in the webview as well.
+  if ([self usesCustomEmbedHost] && [self isEmbedHostURL:url] &&
+      [url.path hasPrefix:@"/embed/"]) {
+    return YES;
+  }
   // Usually this means the user has clicked on the YouTube logo or an error message in the
   // player. Most URLs should open in the browser. The only http(s) URL that should open in this
   // webview is the URL for the embed, which is of the format:
   //     http(s)://www.youtube.com/embed/[VIDEO ID]?[PARAMETERS]
-  NSError *error = NULL;
-  NSRegularExpression *ytRegex =
-      [NSRegularExpression regularExpressionWithPattern:kYTPlayerEmbedUrlRegexPattern
-                                                options:NSRegularExpressionCaseInsensitive
-                                                  error:&error];
-  NSTextCheckingResult *ytMatch =
-      [ytRegex firstMatchInString:url.absoluteString
-                        options:0
-                          range:NSMakeRange(0, [url.absoluteString length])];
-    
-  NSRegularExpression *adRegex =
-      [NSRegularExpression regularExpressionWithPattern:kYTPlayerAdUrlRegexPattern
-                                                options:NSRegularExpressionCaseInsensitive
-                                                  error:&error];
-  NSTextCheckingResult *adMatch =
-      [adRegex firstMatchInString:url.absoluteString
-                        options:0
-                          range:NSMakeRange(0, [url.absoluteString length])];
-    
-  NSRegularExpression *syndicationRegex =
-      [NSRegularExpression regularExpressionWithPattern:kYTPlayerSyndicationRegexPattern
-                                                options:NSRegularExpressionCaseInsensitive
-                                                  error:&error];
-
-  NSTextCheckingResult *syndicationMatch =
-      [syndicationRegex firstMatchInString:url.absoluteString
-                                   options:0
-                                     range:NSMakeRange(0, [url.absoluteString length])];
-
-  NSRegularExpression *oauthRegex =
-      [NSRegularExpression regularExpressionWithPattern:kYTPlayerOAuthRegexPattern
-                                              options:NSRegularExpressionCaseInsensitive
-                                                error:&error];
-  NSTextCheckingResult *oauthMatch =
-    [oauthRegex firstMatchInString:url.absoluteString
-                           options:0
-                             range:NSMakeRange(0, [url.absoluteString length])];
-    
-  NSRegularExpression *staticProxyRegex =
-    [NSRegularExpression regularExpressionWithPattern:kYTPlayerStaticProxyRegexPattern
-                                              options:NSRegularExpressionCaseInsensitive
-                                                error:&error];
-  NSTextCheckingResult *staticProxyMatch =
-    [staticProxyRegex firstMatchInString:url.absoluteString
-                                  options:0
-                                    range:NSMakeRange(0, [url.absoluteString length])];
-
-  if (ytMatch || adMatch || oauthMatch || staticProxyMatch || syndicationMatch) {
+  // Ads, OAuth, the static proxy and syndication frames are allowed as well.
+  if ([YTPlayerView isAllowedNavigationURL:url]) {
     return YES;
-  } else {
-    [[UIApplication sharedApplication] openURL:url
-                                       options:@{UIApplicationOpenURLOptionUniversalLinksOnly: @NO}
-                             completionHandler:nil];
-    return NO;
   }
+  [[UIApplication sharedApplication] openURL:url
+                                     options:@{UIApplicationOpenURLOptionUniversalLinksOnly: @NO}
+                           completionHandler:nil];
+  return NO;
 }
 
+/**
+ * Private method returning whether |url| is one of the YouTube URLs allowed to load in the web
+ * view: the embed, ads, OAuth, the static proxy and syndication frames.
+ */
++ (BOOL)isAllowedNavigationURL:(NSURL *)url {
+  NSString *absoluteString = url.absoluteString;
+  NSRange range = NSMakeRange(0, [absoluteString length]);
+  for (NSRegularExpression *regex in [YTPlayerView allowedNavigationRegexes]) {
+    if ([regex firstMatchInString:absoluteString options:0 range:range]) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+/**
+ * Private helper method returning the compiled patterns of http(s) URLs that may load inside the
+ * webview. The patterns are compiled once and shared by all player views, so navigation checks
+ * do not get more expensive as more players are created.
+ *
+ * @return An array of NSRegularExpression instances.
+ */
++ (NSArray<NSRegularExpression *> *)allowedNavigationRegexes {
+  static NSArray<NSRegularExpression *> *allowedNavigationRegexes = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableArray<NSRegularExpression *> *regexes = [[NSMutableArray alloc] init];
+    for (NSString *pattern in @[ kYTPlayerEmbedUrlRegexPattern,
+                                 kYTPlayerAdUrlRegexPattern,
+                                 kYTPlayerSyndicationRegexPattern,
+                                 kYTPlayerOAuthRegexPattern,
+                                 kYTPlayerStaticProxyRegexPattern ]) {
+      NSError *error = nil;
+      NSRegularExpression *regex =
+          [NSRegularExpression regularExpressionWithPattern:pattern
+                                                    options:NSRegularExpressionCaseInsensitive
+                                                      error:&error];
+      if (regex) {
+        [regexes addObject:regex];
+      }
+    }
+    allowedNavigationRegexes = regexes;
+  });
+  return allowedNavigationRegexes;
+}
+
+
+- (BOOL)loadWithPlayerParams:(NSDictionary *)additionalPlayerParams {
+  return [self loadWithPlayerParams:additionalPlayerParams initialState:nil];
+}
 
 /**
  * Private helper method to load an iframe player with the given player parameters.
@@ -715,15 +1799,11 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
  * @param additionalPlayerParams An NSDictionary of parameters in addition to required parameters
  *                               to instantiate the HTML5 player with. This differs depending on
  *                               whether a single video or playlist is being loaded.
+ * @param initialState The state the player page applies before signalling onReady, or nil.
  * @return YES if successful, NO if not.
  */
-- (BOOL)loadWithPlayerParams:(NSDictionary *)additionalPlayerParams {
-  NSDictionary *playerCallbacks = @{
-        @"onReady" : @"onReady",
-        @"onStateChange" : @"onStateChange",
-        @"onPlaybackQualityChange" : @"onPlaybackQualityChange",
-        @"onError" : @"onPlayerError"
-  };
+- (BOOL)loadWithPlayerParams:(NSDictionary *)additionalPlayerParams
+                initialState:(YTPlayerInitialState *)initialState {
   NSMutableDictionary *playerParams = [[NSMutableDictionary alloc] init];
   if (additionalPlayerParams) {
     [playerParams addEntriesFromDictionary:additionalPlayerParams];
@@ -735,60 +1815,142 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
     [playerParams setValue:@"100%" forKey:@"width"];
   }
 
-  [playerParams setValue:playerCallbacks forKey:@"events"];
+  [playerParams setValue:[YTPlayerView playerCallbacks] forKey:@"events"];
+  if ([self usesCustomEmbedHost]) {
+    [playerParams setValue:[self embedHost] forKey:@"host"];
+  }
   
   NSMutableDictionary *playerVars = [[playerParams objectForKey:@"playerVars"] mutableCopy];
   if (!playerVars) {
     // playerVars must not be empty so we can render a '{}' in the output JSON
     playerVars = [NSMutableDictionary dictionary];
   }
-  // We always want to ovewrite the origin to self.originURL, not just for
+  // We always want to ovewrite the origin to the page's origin, not just for
   // the webView.baseURL
-  [playerVars setObject:self.originURL.absoluteString forKey:@"origin"];
+  [playerVars setObject:self.pageOriginURL.absoluteString forKey:@"origin"];
   [playerParams setValue:playerVars forKey:@"playerVars"];
 
-  // Remove the existing webview to reset any state
-  [self.webView removeFromSuperview];
-  _webView = [self createNewWebView];
-  [self addSubview:self.webView];
-
-  NSError *error = nil;
-  NSString *path = [[NSBundle bundleForClass:[YTPlayerView class]] pathForResource:@"YTPlayerView-iframe-player"
-                                                                            ofType:@"html"];
-    
-  // in case of using Swift and embedded frameworks, resources included not in main bundle,
-  // but in framework bundle
-  if (!path) {
-      path = [[[self class] frameworkBundle] pathForResource:@"YTPlayerView-iframe-player"
-                                                      ofType:@"html"];
-  }
-    
-  NSString *embedHTMLTemplate =
-      [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:&error];
-
-  if (error) {
-    NSLog(@"Received error rendering template: %@", error);
-    return NO;
-  }
-
   // Render the playerVars as a JSON dictionary.
   NSError *jsonRenderingError = nil;
   NSData *jsonData = [NSJSONSerialization dataWithJSONObject:playerParams
                                                      options:NSJSONWritingPrettyPrinted
                                                        error:&jsonRenderingError];
   if (jsonRenderingError) {
-    NSLog(@"Attempted configuration of player with invalid playerVars: %@ \tError: %@",
-          playerParams,
-          jsonRenderingError);
+    YTPlayerLog(kYTPlayerLogLevelError, self.logBuffer,
+                @"Attempted configuration of player with invalid playerVars: %@ \tError: %@",
+                playerParams, jsonRenderingError);
     return NO;
   }
 
   NSString *playerVarsJsonString =
       [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
 
-  NSString *embedHTML = [NSString stringWithFormat:embedHTMLTemplate, playerVarsJsonString];
+  NSString *initialStateJsonString = [YTPlayerView JSONStringForInitialState:initialState];
+  if (!initialStateJsonString) {
+    return NO;
+  }
+
+  return [self loadWithPlayerParamsJSON:playerVarsJsonString
+                       initialStateJSON:initialStateJsonString];
+}
+
+/**
+ * Private helper method rendering an initial state for the player page.
+ *
+ * @param initialState The state to render, or nil.
+ * @return A JSON dictionary, "null" if |initialState| is nil, or nil if it cannot be rendered.
+ */
++ (NSString *)JSONStringForInitialState:(YTPlayerInitialState *)initialState {
+  if (!initialState) {
+    return @"null";
+  }
+  NSError *jsonRenderingError = nil;
+  NSData *initialStateData =
+      [NSJSONSerialization dataWithJSONObject:[initialState dictionaryRepresentation]
+                                      options:0
+                                        error:&jsonRenderingError];
+  if (jsonRenderingError) {
+    YTPlayerLog(kYTPlayerLogLevelError, nil,
+                @"Attempted configuration of player with invalid initialState: %@ \tError: %@",
+                initialState, jsonRenderingError);
+    return nil;
+  }
+  return [[NSString alloc] initWithData:initialStateData encoding:NSUTF8StringEncoding];
+}
+
+/**
+ * Private helper method to load an iframe player with already serialized parameters. Both
+ * YTPlayerView::loadWithPlayerParams:initialState: and
+ * YTPlayerView::loadWithVideoId:configuration: end up here.
+ *
+ * @param playerParamsJSON The JSON object passed to the YT.Player constructor.
+ * @param initialStateJSON The JSON object applied by the page before onReady, or "null".
+ * @return YES if successful, NO if not.
+ */
+- (BOOL)loadWithPlayerParamsJSON:(NSString *)playerParamsJSON
+                initialStateJSON:(NSString *)initialStateJSON {
+  NSString *embedHTMLTemplate = [YTPlayerView embedHTMLTemplate];
+  NSString *bridgeScript = [YTPlayerView bridgeScript];
+  if (!embedHTMLTemplate || !bridgeScript) {
+    return NO;
+  }
+  BOOL usesPageSchemeHandler = [self usesPageSchemeHandler];
+  NSString *bridgeScriptTag;
+  if (usesPageSchemeHandler) {
+    bridgeScriptTag = [NSString stringWithFormat:@"<script src=\"%@\"></script>",
+                                                 self.pageServer.bridgeScriptPath];
+  } else {
+    bridgeScriptTag = [NSString stringWithFormat:@"<script>\n%@</script>", bridgeScript];
+  }
+  if (!self.playerId && ![self beginIframeAPIAttempt]) {
+    return NO;
+  }
+  [self discardPreparedLoad];
+  _playerReady = NO;
+  YTPlayerLog(kYTPlayerLogLevelInfo, self.logBuffer, @"Loading player%@",
+              usesPageSchemeHandler ? @" from memory" : @"");
+
+  // Remove the existing webview to reset any state
+  [self.bufferEstimator reset];
+  [self.watchedRanges reset];
+  [[self latencyEstimator] reset];
+  _bridgeClockSynchronized = NO;
+  [self.metrics reset];
+  [self.eventScheduler removeAllEventsFromSource:self];
+  [self.commandEffectTracker cancelAllCommandsAtTime:CACurrentMediaTime()];
+  _loadedPlayerParamsJSON = [playerParamsJSON copy];
+  _replacedLoadedVideo = NO;
+  _currentVideoId = nil;
+  _currentPlaylist = nil;
+  _currentPlaylistIndex = -1;
+  _lastPlayTime = 0;
+  _lastPlaybackRate = 1;
+  self.lastReportedState = kYTPlayerStateUnstarted;
+  self.hibernating = NO;
+
+  if (self.playerId) {
+    [self.hostView loadPlayerWithId:self.playerId
+                   playerParamsJSON:playerParamsJSON
+                   initialStateJSON:initialStateJSON];
+    return YES;
+  }
+  [self.webView removeFromSuperview];
+  _webView = [self createNewWebView];
+  [self addSubview:self.webView];
+
+  NSString *embedHTML = [NSString stringWithFormat:embedHTMLTemplate,
+                                                   playerParamsJSON,
+                                                   initialStateJSON,
+                                                   bridgeScriptTag,
+                                                   [self embedHost]];
 
-  [self.webView loadHTMLString:embedHTML baseURL: self.originURL];
+  if (usesPageSchemeHandler) {
+    self.pageServer.pageHTML = embedHTML;
+    NSURL *pageURL = [NSURL URLWithString:self.pageServer.pagePath relativeToURL:self.pageOriginURL];
+    [self.webView loadRequest:[NSURLRequest requestWithURL:pageURL]];
+  } else {
+    [self.webView loadHTMLString:embedHTML baseURL: self.originURL];
+  }
   self.webView.navigationDelegate = self;
   self.webView.UIDelegate = self;
 
@@ -805,6 +1967,162 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
   return YES;
 }
 
+/**
+ * Private method asking YTPlayerView::circuitBreaker whether the iframe API may be loaded. Any
+ * attempt still in flight is abandoned first. If the breaker refuses, the delegate is told.
+ *
+ * @return YES if the load may go ahead.
+ */
+- (BOOL)beginIframeAPIAttempt {
+  [self abandonIframeAPIAttempt];
+  YTPlayerCircuitBreaker *circuitBreaker = self.circuitBreaker;
+  BOOL probe = circuitBreaker.state != kYTPlayerCircuitBreakerStateClosed;
+  if (![circuitBreaker shouldAttemptAtTime:CACurrentMediaTime()]) {
+    YTPlayerLog(kYTPlayerLogLevelWarning, self.logBuffer,
+                @"Not loading the iframe API after %lu consecutive failures",
+                (unsigned long)circuitBreaker.consecutiveFailureCount);
+    [self notifyDelegateOfIframeAPIError:kYTPlayerViewErrorIframeAPIUnavailable];
+    return NO;
+  }
+  _awaitingIframeAPI = YES;
+  _iframeAPIProbe = probe;
+  return YES;
+}
+
+/**
+ * Private method giving up on the iframe API load in flight, if any, so that an abandoned probe
+ * does not keep YTPlayerView::circuitBreaker half-open.
+ */
+- (void)abandonIframeAPIAttempt {
+  if (_awaitingIframeAPI && _iframeAPIProbe) {
+    [self.circuitBreaker recordAbandonedAttempt];
+  }
+  _awaitingIframeAPI = NO;
+}
+
+/**
+ * Private method telling the delegate that the iframe API could not be loaded.
+ *
+ * @param code The reason, in YTPlayerViewErrorDomain.
+ */
+- (void)notifyDelegateOfIframeAPIError:(YTPlayerViewError)code {
+  if ([self.delegate respondsToSelector:@selector(playerView:didFailToLoadIframeAPIWithError:)]) {
+    NSString *description = code == kYTPlayerViewErrorIframeAPIUnavailable
+        ? @"The YouTube iframe API is unavailable after repeated failures to load it."
+        : @"The YouTube iframe API failed to load.";
+    NSError *error = [NSError errorWithDomain:YTPlayerViewErrorDomain
+                                         code:code
+                                     userInfo:@{NSLocalizedDescriptionKey : description}];
+    [self.delegate playerView:self didFailToLoadIframeAPIWithError:error];
+  }
+}
+
+/**
+ * Private helper method returning the events map that wires IFrame API events to the page's
+ * callback functions.
+ *
+ * @return An NSDictionary mapping event names to page function names.
+ */
++ (NSDictionary *)playerCallbacks {
+  return @{
+        @"onReady" : @"onReady",
+        @"onStateChange" : @"onStateChange",
+        @"onPlaybackQualityChange" : @"onPlaybackQualityChange",
+        @"onError" : @"onPlayerError",
+        @"onPlaybackRateChange" : @"onPlaybackRateChange",
+        @"onApiChange" : @"onApiChange",
+        @"onAutoplayBlocked" : @"onAutoplayBlocked"
+  };
+}
+
+/**
+ * Private helper method returning YTPlayerView::playerCallbacks serialized as JSON. The result
+ * is computed once and shared by all loads that use a YTPlayerConfiguration.
+ *
+ * @return A JSON object literal.
+ */
++ (NSString *)playerCallbacksJSON {
+  static NSString *playerCallbacksJSON = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSData *data = [NSJSONSerialization dataWithJSONObject:[self playerCallbacks]
+                                                   options:0
+                                                     error:nil];
+    playerCallbacksJSON = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  });
+  return playerCallbacksJSON;
+}
+
+/**
+ * Private helper method returning the contents of the player page template. The template is read
+ * from disk once, on first use, and kept in memory afterwards.
+ *
+ * @return The template, or nil if it could not be read.
+ */
++ (NSString *)embedHTMLTemplate {
+  static NSString *embedHTMLTemplate = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    embedHTMLTemplate = [self contentsOfResource:@"YTPlayerView-iframe-player" ofType:@"html"];
+  });
+  return embedHTMLTemplate;
+}
+
+/**
+ * Private helper method returning the bridge script shared by every player page.
+ *
+ * @return The JavaScript source, or nil if it cannot be read.
+ */
+/**
+ * Private method returning the process pool of the web views of players served from memory.
+ */
++ (WKProcessPool *)sharedProcessPool {
+  static WKProcessPool *sharedProcessPool = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    sharedProcessPool = [[WKProcessPool alloc] init];
+  });
+  return sharedProcessPool;
+}
+
++ (NSString *)bridgeScript {
+  static NSString *bridgeScript = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    bridgeScript = [self contentsOfResource:@"YTPlayerView-bridge" ofType:@"js"];
+  });
+  return bridgeScript;
+}
+
+/**
+ * Private helper method reading a resource shipped with the library.
+ *
+ * @param name The resource name.
+ * @param type The resource extension.
+ * @return The resource contents, or nil if it could not be read.
+ */
++ (NSString *)contentsOfResource:(NSString *)name ofType:(NSString *)type {
+  NSError *error = nil;
+  NSString *path = [[NSBundle bundleForClass:[YTPlayerView class]] pathForResource:name
+                                                                            ofType:type];
+    
+  // in case of using Swift and embedded frameworks, resources included not in main bundle,
+  // but in framework bundle
+  if (!path) {
+      path = [[self frameworkBundle] pathForResource:name ofType:type];
+  }
+    
+  NSString *contents =
+      [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:&error];
+
+  if (error) {
+    YTPlayerLog(kYTPlayerLogLevelError, nil,
+                @"Received error reading %@.%@: %@", name, type, error);
+    return nil;
+  }
+  return contents;
+}
+
 /**
  * Private method for cueing both cases of playlist ID and array of video IDs. Cueing
  * a playlist does not start playback.
@@ -876,11 +2194,15 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
  */
 - (void)evaluateJavaScript:(NSString *)jsToExecute
          completionHandler:(void(^)(id _Nullable result, NSError *_Nullable error))completionHandler {
-  [_webView evaluateJavaScript:jsToExecute
-             completionHandler:^(id _Nullable result, NSError *_Nullable error) {
+  YTPlayerMetrics *metrics = self.metrics;
+  CFTimeInterval sendTime = CACurrentMediaTime();
+  void (^resultHandler)(id _Nullable result, NSError *_Nullable error) =
+      ^(id _Nullable result, NSError *_Nullable error) {
+    [metrics recordCommandCompleted];
     if (!completionHandler) {
       return;
     }
+    [metrics recordGetterRoundTrip:CACurrentMediaTime() - sendTime];
     if (error) {
       completionHandler(nil, error);
       return;
@@ -892,7 +2214,18 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
     }
 
     completionHandler(result, nil);
-  }];
+  };
+  if (self.playerId) {
+    if (completionHandler) {
+      [metrics recordCommandSent];
+    }
+    [self.hostView evaluateJavaScript:jsToExecute
+                          forPlayerId:self.playerId
+                    completionHandler:completionHandler ? resultHandler : nil];
+    return;
+  }
+  [metrics recordCommandSent];
+  [_webView evaluateJavaScript:jsToExecute completionHandler:resultHandler];
 }
 
 /**
@@ -915,6 +2248,19 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
   WKWebViewConfiguration *webViewConfiguration = [[WKWebViewConfiguration alloc] init];
   webViewConfiguration.allowsInlineMediaPlayback = YES;
   webViewConfiguration.mediaTypesRequiringUserActionForPlayback = WKAudiovisualMediaTypeNone;
+  if (@available(iOS 11.0, *)) {
+    if (self.servesPageFromMemory && self.pageServer) {
+      // The server and its handler are kept across loads, and every player served from memory
+      // shares one web content process.
+      if (!self.pageSchemeHandler) {
+        self.pageSchemeHandler =
+            [[YTPlayerPageSchemeHandler alloc] initWithServer:self.pageServer];
+      }
+      [webViewConfiguration setURLSchemeHandler:self.pageSchemeHandler
+                                   forURLScheme:kYTPlayerPageURLScheme];
+      webViewConfiguration.processPool = [YTPlayerView sharedProcessPool];
+    }
+  }
   WKWebView *webView = [[WKWebView alloc] initWithFrame:self.bounds
                                           configuration:webViewConfiguration];
   webView.autoresizingMask = (UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight);
@@ -931,6 +2277,11 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
 }
 
 - (void)removeWebView {
+  [self abandonIframeAPIAttempt];
+  [self discardPreparedLoad];
+  _playerReady = NO;
+  [_commandEffectTracker cancelAllCommandsAtTime:CACurrentMediaTime()];
+  [self stopSphericalDisplayLink];
   [self.webView removeFromSuperview];
   self.webView = nil;
 }
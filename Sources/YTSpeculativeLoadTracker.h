@@ -0,0 +1,75 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ * YTSpeculativeLoadTracker keeps the books on speculative loads: loads started on a sign of
+ * intent, such as a touch down on a feed item, before the user has committed to watching. Each
+ * speculative load ends either committed, when the intent turned into a tap, or cancelled, when
+ * it turned into a scroll and the load was wasted.
+ *
+ * YTPlayerView reports its speculative loads to YTSpeculativeLoadTracker::sharedTracker unless
+ * given its own, so the statistics cover a whole feed. The tracker should only be used from the
+ * main thread. Times are in seconds on a monotonic clock such as CACurrentMediaTime().
+ */
+@interface YTSpeculativeLoadTracker : NSObject
+
+/** The tracker shared by all players that do not have their own. */
++ (nonnull YTSpeculativeLoadTracker *)sharedTracker;
+
+/** The number of speculative loads neither committed nor cancelled yet. */
+@property(nonatomic, readonly) NSUInteger pendingLoadCount;
+
+/** The number of speculative loads that were committed. */
+@property(nonatomic, readonly) NSUInteger committedLoadCount;
+
+/** The number of speculative loads that were cancelled, i.e. wasted. */
+@property(nonatomic, readonly) NSUInteger cancelledLoadCount;
+
+/** The fraction of finished speculative loads that were wasted, or 0 before any finished. */
+@property(nonatomic, readonly) double wastedLoadFraction;
+
+/**
+ * The mean time between starting a speculative load and committing it: how much earlier than
+ * the tap the committed loads started. 0 before any was committed.
+ */
+@property(nonatomic, readonly) NSTimeInterval meanHeadStart;
+
+/**
+ * Records the start of a speculative load.
+ *
+ * @param time The time the load started.
+ * @return A token identifying the load in later calls.
+ */
+- (NSUInteger)beginLoadAtTime:(NSTimeInterval)time;
+
+/**
+ * Records that the load identified by |token| was committed.
+ *
+ * @return NO if the load had already finished or is unknown.
+ */
+- (BOOL)commitLoad:(NSUInteger)token atTime:(NSTimeInterval)time;
+
+/**
+ * Records that the load identified by |token| was cancelled.
+ *
+ * @return NO if the load had already finished or is unknown.
+ */
+- (BOOL)cancelLoad:(NSUInteger)token;
+
+/** Forgets all loads and statistics. */
+- (void)reset;
+
+@end
@@ -0,0 +1,94 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTSpeculativeLoadTracker.h"
+
+@implementation YTSpeculativeLoadTracker {
+  // Start times of the pending loads, by token.
+  NSMutableDictionary<NSNumber *, NSNumber *> *_pendingLoads;
+  NSUInteger _nextToken;
+  NSTimeInterval _totalHeadStart;
+}
+
++ (YTSpeculativeLoadTracker *)sharedTracker {
+  static YTSpeculativeLoadTracker *sharedTracker = nil;
+  static dispatch_once_t predicate;
+  dispatch_once(&predicate, ^{
+    sharedTracker = [[YTSpeculativeLoadTracker alloc] init];
+  });
+  return sharedTracker;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _pendingLoads = [[NSMutableDictionary alloc] init];
+    _nextToken = 1;
+  }
+  return self;
+}
+
+- (NSUInteger)pendingLoadCount {
+  return _pendingLoads.count;
+}
+
+- (double)wastedLoadFraction {
+  NSUInteger finishedLoadCount = self.committedLoadCount + self.cancelledLoadCount;
+  if (finishedLoadCount == 0) {
+    return 0;
+  }
+  return (double)self.cancelledLoadCount / finishedLoadCount;
+}
+
+- (NSTimeInterval)meanHeadStart {
+  if (self.committedLoadCount == 0) {
+    return 0;
+  }
+  return _totalHeadStart / self.committedLoadCount;
+}
+
+- (NSUInteger)beginLoadAtTime:(NSTimeInterval)time {
+  NSUInteger token = _nextToken++;
+  _pendingLoads[@(token)] = @(time);
+  return token;
+}
+
+- (BOOL)commitLoad:(NSUInteger)token atTime:(NSTimeInterval)time {
+  NSNumber *startTime = _pendingLoads[@(token)];
+  if (!startTime) {
+    return NO;
+  }
+  [_pendingLoads removeObjectForKey:@(token)];
+  _committedLoadCount++;
+  _totalHeadStart += MAX(time - [startTime doubleValue], 0);
+  return YES;
+}
+
+- (BOOL)cancelLoad:(NSUInteger)token {
+  if (!_pendingLoads[@(token)]) {
+    return NO;
+  }
+  [_pendingLoads removeObjectForKey:@(token)];
+  _cancelledLoadCount++;
+  return YES;
+}
+
+- (void)reset {
+  [_pendingLoads removeAllObjects];
+  _committedLoadCount = 0;
+  _cancelledLoadCount = 0;
+  _totalHeadStart = 0;
+}
+
+@end
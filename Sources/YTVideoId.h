@@ -0,0 +1,57 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** The number of characters in a YouTube video ID. */
+static const NSUInteger kYTVideoIdLength = 11;
+
+/**
+ * YTVideoId is a YouTube video ID packed into 64 bits. Video IDs are 11 characters of the URL-safe
+ * base64 alphabet, and the last one only takes 16 of its values, so an ID fits in 10 * 6 + 4
+ * bits. The ID is validated once when it is created; afterwards hashing and comparison only
+ * look at the packed value, and the characters can be written out without escaping.
+ *
+ * Video IDs are converted at the API boundary: the library accepts and returns NSString, and
+ * packs the IDs it keeps, e.g. in YTPlayQueue, where possible. Strings that are not well-formed
+ * video IDs cannot be packed and are kept as strings.
+ */
+@interface YTVideoId : NSObject <NSCopying>
+
+/**
+ * Returns the packed form of |string|, or nil if it is not a well-formed video ID.
+ */
++ (nullable instancetype)videoIdWithString:(nullable NSString *)string;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/** Initializes a video ID from a value returned by YTVideoId::packedValue. */
+- (nonnull instancetype)initWithPackedValue:(uint64_t)packedValue NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The packed ID. Values compare in the order of the base64 alphabet (A-Z, a-z, 0-9, -, _),
+ * character by character, which is not the order of the strings.
+ */
+@property(nonatomic, readonly) uint64_t packedValue;
+
+/** The video ID as a string. */
+@property(nonatomic, readonly, nonnull) NSString *stringValue;
+
+/** Writes the kYTVideoIdLength characters of the ID to |characters|. */
+- (void)getCharacters:(nonnull unichar *)characters;
+
+/** Compares two IDs by YTVideoId::packedValue. */
+- (NSComparisonResult)compare:(nonnull YTVideoId *)otherVideoId;
+
+@end
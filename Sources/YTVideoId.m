@@ -0,0 +1,118 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTVideoId.h"
+
+// The URL-safe base64 alphabet, in the order of the 6-bit values it encodes.
+static const char kYTVideoIdAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/**
+ * Returns the 6-bit value of |character|, or -1 if it is not in the alphabet.
+ */
+static inline int YTVideoIdValueOfCharacter(unichar character) {
+  static int8_t values[128];
+  static dispatch_once_t predicate;
+  dispatch_once(&predicate, ^{
+    memset(values, -1, sizeof(values));
+    for (int value = 0; value < 64; value++) {
+      values[(unsigned char)kYTVideoIdAlphabet[value]] = (int8_t)value;
+    }
+  });
+  return character < 128 ? values[character] : -1;
+}
+
+@implementation YTVideoId
+
++ (instancetype)videoIdWithString:(NSString *)string {
+  if (string.length != kYTVideoIdLength) {
+    return nil;
+  }
+  unichar characters[kYTVideoIdLength];
+  [string getCharacters:characters range:NSMakeRange(0, kYTVideoIdLength)];
+  uint64_t packedValue = 0;
+  for (NSUInteger i = 0; i < kYTVideoIdLength - 1; i++) {
+    int value = YTVideoIdValueOfCharacter(characters[i]);
+    if (value < 0) {
+      return nil;
+    }
+    packedValue = (packedValue << 6) | (uint64_t)value;
+  }
+  // The last character only carries 4 bits; its two low bits are always 0.
+  int lastValue = YTVideoIdValueOfCharacter(characters[kYTVideoIdLength - 1]);
+  if (lastValue < 0 || (lastValue & 3) != 0) {
+    return nil;
+  }
+  packedValue = (packedValue << 4) | (uint64_t)(lastValue >> 2);
+  return [[self alloc] initWithPackedValue:packedValue];
+}
+
+- (instancetype)initWithPackedValue:(uint64_t)packedValue {
+  self = [super init];
+  if (self) {
+    _packedValue = packedValue;
+  }
+  return self;
+}
+
+- (void)getCharacters:(unichar *)characters {
+  uint64_t packedValue = self.packedValue;
+  characters[kYTVideoIdLength - 1] = kYTVideoIdAlphabet[(packedValue & 0xF) << 2];
+  packedValue >>= 4;
+  for (NSInteger i = kYTVideoIdLength - 2; i >= 0; i--) {
+    characters[i] = kYTVideoIdAlphabet[packedValue & 0x3F];
+    packedValue >>= 6;
+  }
+}
+
+- (NSString *)stringValue {
+  unichar characters[kYTVideoIdLength];
+  [self getCharacters:characters];
+  return [[NSString alloc] initWithCharacters:characters length:kYTVideoIdLength];
+}
+
+- (NSComparisonResult)compare:(YTVideoId *)otherVideoId {
+  if (self.packedValue < otherVideoId.packedValue) {
+    return NSOrderedAscending;
+  }
+  if (self.packedValue > otherVideoId.packedValue) {
+    return NSOrderedDescending;
+  }
+  return NSOrderedSame;
+}
+
+- (BOOL)isEqual:(id)object {
+  if (object == self) {
+    return YES;
+  }
+  return [object isKindOfClass:[YTVideoId class]] &&
+         ((YTVideoId *)object).packedValue == self.packedValue;
+}
+
+- (NSUInteger)hash {
+  // Fold the high bits in for 32-bit platforms and so the first characters count everywhere.
+  return (NSUInteger)(self.packedValue ^ (self.packedValue >> 32));
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+  // Video IDs are immutable.
+  return self;
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"<%@: %p; %@>",
+                                    NSStringFromClass([self class]), self, self.stringValue];
+}
+
+@end
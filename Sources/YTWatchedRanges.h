@@ -0,0 +1,84 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/** A part of a video, from |start| to |end| in seconds. */
+typedef struct {
+    double start;
+    double end;
+} YTWatchedRange;
+
+/**
+ * YTWatchedRanges records which parts of a video were watched, as a sorted set of disjoint
+ * ranges. Overlapping and touching ranges are merged as they are added, so the set stays as small
+ * as the number of distinct stretches watched, and the watched duration is kept as a running
+ * total.
+ *
+ * Ranges can be added directly, or derived from play time samples: consecutive samples are
+ * joined when the playhead advanced by about the expected amount for the wall time elapsed and
+ * the playback rate, and left apart otherwise, so seeks do not count the skipped part as
+ * watched. Pauses and buffering should end sampling with
+ * YTWatchedRanges::interruptSampling.
+ *
+ * YTPlayerView feeds its watched ranges from the play time reports of the player page and
+ * resets them when a new video starts. Times are in seconds.
+ */
+@interface YTWatchedRanges : NSObject
+
+/** The duration of the video, used for YTWatchedRanges::watchedFraction. */
+@property(nonatomic) double duration;
+
+/** The total length of the watched ranges. */
+@property(nonatomic, readonly) double watchedDuration;
+
+/** The fraction of YTWatchedRanges::duration watched, between 0 and 1, or 0 if it is unknown. */
+@property(nonatomic, readonly) double watchedFraction;
+
+/** The number of disjoint ranges. */
+@property(nonatomic, readonly) NSUInteger rangeCount;
+
+/** Returns the range at |index|, ranges being sorted by start time. */
+- (YTWatchedRange)rangeAtIndex:(NSUInteger)index;
+
+/** Returns whether |time| lies in a watched range. Runs in O(log n) for n ranges. */
+- (BOOL)containsTime:(double)time;
+
+/**
+ * Marks the part of the video from |start| to |end| as watched. Ranges that do not have a
+ * positive length are ignored.
+ */
+- (void)addRangeFromTime:(double)start toTime:(double)end;
+
+/**
+ * Adds a play time sample.
+ *
+ * @param currentTime The playhead position.
+ * @param playbackRate The playback rate since the previous sample.
+ * @param timestamp The wall-clock time the sample was taken.
+ */
+- (void)addSampleWithCurrentTime:(double)currentTime
+                    playbackRate:(double)playbackRate
+                       timestamp:(NSTimeInterval)timestamp;
+
+/**
+ * Makes the next sample start a new range instead of joining the previous one, e.g. when
+ * playback pauses, buffers or ends.
+ */
+- (void)interruptSampling;
+
+/** Forgets all ranges, samples and the duration. */
+- (void)reset;
+
+@end
@@ -0,0 +1,136 @@
+// Copyright 2014 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "YTWatchedRanges.h"
+
+// How far the playhead may be from where the elapsed time and playback rate put it for two
+// samples to still be joined, as a fraction of the expected advance, and at least in seconds.
+// Play time is reported twice a second, so timer jitter alone is a good part of a report period.
+static const double kYTWatchedRangesRelativeTolerance = 0.5;
+static const double kYTWatchedRangesMinimumTolerance = 0.5;
+
+@implementation YTWatchedRanges {
+  // The ranges, sorted and disjoint, in a buffer of |_capacity| entries.
+  YTWatchedRange *_ranges;
+  NSUInteger _rangeCount;
+  NSUInteger _capacity;
+  BOOL _hasSample;
+  double _lastCurrentTime;
+  NSTimeInterval _lastTimestamp;
+}
+
+- (void)dealloc {
+  free(_ranges);
+}
+
+- (NSUInteger)rangeCount {
+  return _rangeCount;
+}
+
+- (double)watchedFraction {
+  if (self.duration <= 0) {
+    return 0;
+  }
+  return MIN(self.watchedDuration / self.duration, 1);
+}
+
+- (YTWatchedRange)rangeAtIndex:(NSUInteger)index {
+  NSAssert(index < _rangeCount, @"Range index out of bounds");
+  return _ranges[index];
+}
+
+- (BOOL)containsTime:(double)time {
+  NSUInteger index = [self indexOfFirstRangeEndingAtOrAfter:time];
+  return index < _rangeCount && _ranges[index].start <= time;
+}
+
+- (void)addRangeFromTime:(double)start toTime:(double)end {
+  if (!(end > start)) {
+    return;
+  }
+  // The ranges from |first| up to |last| overlap or touch the new one and are merged into it.
+  NSUInteger first = [self indexOfFirstRangeEndingAtOrAfter:start];
+  NSUInteger last = first;
+  while (last < _rangeCount && _ranges[last].start <= end) {
+    last++;
+  }
+  YTWatchedRange merged = { start, end };
+  double removedDuration = 0;
+  for (NSUInteger i = first; i < last; i++) {
+    merged.start = MIN(merged.start, _ranges[i].start);
+    merged.end = MAX(merged.end, _ranges[i].end);
+    removedDuration += _ranges[i].end - _ranges[i].start;
+  }
+
+  NSUInteger newCount = _rangeCount - (last - first) + 1;
+  if (newCount > _capacity) {
+    _capacity = MAX(_capacity * 2, 8);
+    _ranges = reallocf(_ranges, _capacity * sizeof(YTWatchedRange));
+  }
+  NSUInteger insertion = first + 1;
+  memmove(&_ranges[insertion], &_ranges[last], (_rangeCount - last) * sizeof(YTWatchedRange));
+  _ranges[first] = merged;
+  _rangeCount = newCount;
+  _watchedDuration += (merged.end - merged.start) - removedDuration;
+}
+
+- (void)addSampleWithCurrentTime:(double)currentTime
+                    playbackRate:(double)playbackRate
+                       timestamp:(NSTimeInterval)timestamp {
+  if (_hasSample) {
+    double advance = currentTime - _lastCurrentTime;
+    double expectedAdvance = MAX(playbackRate, 0) * (timestamp - _lastTimestamp);
+    double tolerance = MAX(expectedAdvance * kYTWatchedRangesRelativeTolerance,
+                           kYTWatchedRangesMinimumTolerance);
+    if (advance > 0 && fabs(advance - expectedAdvance) <= tolerance) {
+      [self addRangeFromTime:_lastCurrentTime toTime:currentTime];
+    }
+  }
+  _hasSample = YES;
+  _lastCurrentTime = currentTime;
+  _lastTimestamp = timestamp;
+}
+
+- (void)interruptSampling {
+  _hasSample = NO;
+}
+
+- (void)reset {
+  _rangeCount = 0;
+  _watchedDuration = 0;
+  _duration = 0;
+  _hasSample = NO;
+}
+
+#pragma mark - Private methods
+
+/**
+ * Private method returning the index of the first range whose end is at or after |time|, or the
+ * number of ranges if there is none, by binary search.
+ */
+- (NSUInteger)indexOfFirstRangeEndingAtOrAfter:(double)time {
+  NSUInteger low = 0;
+  NSUInteger high = _rangeCount;
+  while (low < high) {
+    NSUInteger middle = low + (high - low) / 2;
+    if (_ranges[middle].end < time) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+@end
@@ -16,4 +16,23 @@ FOUNDATION_EXPORT const unsigned char youtube_ios_player_helperVersionString[];
 
 // In this header, you should import all the public headers of your framework using statements like #import <youtube_ios_player_helper/PublicHeader.h>
 
-#import "YTPlayerView.h"
\ No newline at end of file
+#import "YTPlayerView.h"
+#import "YTAutoplaySelector.h"
+#import "YTBridgeEventScheduler.h"
+#import "YTBridgeLatencyEstimator.h"
+#import "YTBufferEstimator.h"
+#import "YTCommandEffectTracker.h"
+#import "YTPlayQueue.h"
+#import "YTPlayerBudgetManager.h"
+#import "YTPlayerCircuitBreaker.h"
+#import "YTPlayerCommandEncoder.h"
+#import "YTPlayerConfiguration.h"
+#import "YTPlayerHostView.h"
+#import "YTPlayerInitialState.h"
+#import "YTPlayerLogger.h"
+#import "YTPlayerMetrics.h"
+#import "YTPlayerMetricsHUDView.h"
+#import "YTPlayerPageServer.h"
+#import "YTSpeculativeLoadTracker.h"
+#import "YTVideoId.h"
+#import "YTWatchedRanges.h"